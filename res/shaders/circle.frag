@@ -1,22 +1,24 @@
 #version 330 core
-in vec2 FragPos;
+// Turns the unit quad into a circle with an analytic signed distance, so a circle costs the same 4 vertices as a rect.
+// Works with both shape.vert (single circles) and instanced.vert (layers of circles).
+in vec2 localPos;
+flat in vec4 shapeColor;
 out vec4 FragColor;
 
-uniform vec3 Color;
-uniform vec2 CircleCenter;
-uniform float Radius;
-
 void main()
 {
-    // Calculate the distance from the center of the circle to the fragment
-    float distance = length(FragPos - CircleCenter);
+    // Distance from the edge of the circle, in quad units (negative inside, the quad spans -0.5 to 0.5)
+    float dist = length(localPos) - 0.5;
+
+    // Fade out over about one pixel for a smooth edge
+    float edge = fwidth(dist);
+    float coverage = 1.0 - smoothstep(-edge, edge, dist);
 
-    // If the distance is greater than the radius of the circle, discard the fragment
-    if (distance > Radius)
+    // Skip the corners of the quad entirely
+    if (coverage <= 0.0)
     {
         discard;
     }
 
-    // If fragment is inside the circle, color it
-    FragColor = vec4(Color, 1.0f);
+    FragColor = vec4(shapeColor.rgb, shapeColor.a * coverage);
 }
@@ -0,0 +1,33 @@
+#version 330 core
+
+layout (location = 0) in vec2 aPos;
+// Per-instance attributes (advance once per rect, not once per vertex)
+// xy = center of the rect, zw = size of the rect
+layout (location = 1) in vec4 instanceTransform;
+// RGBA8 color, red in the lowest byte
+layout (location = 2) in uint instanceColor;
+
+flat out vec4 shapeColor;
+// Position inside the unit mesh (-0.5 to 0.5), for fragment shaders that shape the mesh (see circle.frag)
+out vec2 localPos;
+
+// Shared by every program, written once per frame (see FrameUniforms)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+};
+// Depth of the draw layer (0 = furthest back), set by the render queue for the depth test
+uniform float depth;
+
+vec4 unpackColor(uint packed)
+{
+    return vec4(packed & 0xFFu, (packed >> 8) & 0xFFu, (packed >> 16) & 0xFFu, packed >> 24) / 255.0;
+}
+
+void main()
+{
+    shapeColor = unpackColor(instanceColor);
+    localPos = aPos;
+    gl_Position = projection * vec4(instanceTransform.xy + aPos * instanceTransform.zw, depth, 1.0);
+}
@@ -0,0 +1,40 @@
+#version 330 core
+// instanced.vert with a horizontal scroll, for scenery layers (e.g. the mountains) that drift for parallax.
+// Instances are laid out once over [-margin, width + margin) and wrap around, so scrolling never touches the instance buffer.
+
+layout (location = 0) in vec2 aPos;
+// Per-instance attributes (advance once per shape, not once per vertex)
+// xy = center of the shape, zw = size of the shape
+layout (location = 1) in vec4 instanceTransform;
+// RGBA8 color, red in the lowest byte
+layout (location = 2) in uint instanceColor;
+
+flat out vec4 shapeColor;
+// Position inside the unit mesh (-0.5 to 0.5), for fragment shaders that shape the mesh (see circle.frag)
+out vec2 localPos;
+
+// Shared by every program, written once per frame (see FrameUniforms)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+};
+// Depth of the draw layer (0 = furthest back), set by the render queue for the depth test
+uniform float depth;
+// Distance the layer has scrolled, in pixels
+uniform float scroll;
+// x = margin kept off each side of the screen, y = total wrap width (screen width + 2 * margin)
+uniform vec2 wrap;
+
+vec4 unpackColor(uint packed)
+{
+    return vec4(packed & 0xFFu, (packed >> 8) & 0xFFu, (packed >> 16) & 0xFFu, packed >> 24) / 255.0;
+}
+
+void main()
+{
+    shapeColor = unpackColor(instanceColor);
+    localPos = aPos;
+    float x = mod(instanceTransform.x + wrap.x + scroll, wrap.y) - wrap.x;
+    gl_Position = projection * vec4(vec2(x, instanceTransform.y) + aPos * instanceTransform.zw, depth, 1.0);
+}
@@ -1,9 +1,8 @@
 #version 330 core
 
+flat in vec4 shapeColor;
 out vec4 FragColor;
 
-uniform vec4 shapeColor;
-
 void main()
 {
     FragColor = shapeColor;
@@ -2,10 +2,31 @@
 
 layout (location = 0) in vec2 aPos;
 
-uniform mat4 model;
-uniform mat4 projection;
+// xy = center of the shape, zw = size of the shape (replaces a full model matrix)
+uniform vec4 transform;
+// RGBA8 color, red in the lowest byte
+uniform uint packedColor;
+// Shared by every program, written once per frame (see FrameUniforms)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+};
+// Depth of the draw layer (0 = furthest back), set by the render queue for the depth test
+uniform float depth;
+
+flat out vec4 shapeColor;
+// Position inside the unit mesh (-0.5 to 0.5), for fragment shaders that shape the mesh (see circle.frag)
+out vec2 localPos;
+
+vec4 unpackColor(uint packed)
+{
+    return vec4(packed & 0xFFu, (packed >> 8) & 0xFFu, (packed >> 16) & 0xFFu, packed >> 24) / 255.0;
+}
 
 void main()
 {
-    gl_Position = projection * model * vec4(aPos.x, aPos.y, 0.0, 1.0);
+    shapeColor = unpackColor(packedColor);
+    localPos = aPos;
+    gl_Position = projection * vec4(transform.xy + aPos * transform.zw, depth, 1.0);
 }
\ No newline at end of file
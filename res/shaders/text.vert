@@ -1,11 +1,27 @@
 #version 330 core
-layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>
+layout (location = 0) in vec4 vertex; // <vec2 pos, vec2 tex>, pos in screen pixels
+// RGBA8 color, red in the lowest byte (per vertex, so strings of any color can share a draw)
+layout (location = 1) in uint vertexColor;
 out vec2 TexCoords;
+flat out vec4 TextColor;
 
-uniform mat4 projection;
+// Shared by every program, written once per frame (see FrameUniforms)
+layout (std140) uniform FrameData {
+    mat4 projection;
+    vec2 viewport;
+    float time;
+};
+// Depth of the draw layer (0 = furthest back), set by the render queue for the depth test
+uniform float depth;
+
+vec4 unpackColor(uint packed)
+{
+    return vec4(packed & 0xFFu, (packed >> 8) & 0xFFu, (packed >> 16) & 0xFFu, packed >> 24) / 255.0;
+}
 
 void main()
 {
-    gl_Position = projection * vec4(vertex.xy, 0.0, 1.0);
+    gl_Position = projection * vec4(vertex.xy, depth, 1.0);
     TexCoords = vertex.zw;
-}  
\ No newline at end of file
+    TextColor = unpackColor(vertexColor);
+}
\ No newline at end of file
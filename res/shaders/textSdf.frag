@@ -0,0 +1,19 @@
+#version 330 core
+// Text from a signed distance field atlas (see GlyphMode::SDF). The atlas stores the distance to the glyph's
+// outline (0.5 on the outline, higher inside), so glyphs stay sharp at any scale instead of blurring like bitmaps.
+in vec2 TexCoords;
+flat in vec4 TextColor;
+out vec4 color;
+
+uniform sampler2D text;
+
+void main()
+{
+    float dist = texture(text, TexCoords).r;
+
+    // Fade out over about one screen pixel, however much the glyph is scaled
+    float edge = fwidth(dist);
+    float coverage = smoothstep(0.5 - edge, 0.5 + edge, dist);
+
+    color = vec4(TextColor.rgb, TextColor.a * coverage);
+}
@@ -1,11 +1,20 @@
 #include "engine.h"
 #include <iostream>
 #include <cstdlib>
+#include <cmath>
+#include <algorithm>
 #include <sstream>
+#include <thread>
 
 enum state {start, level1, level2, level3, level4, over};
 state screen;
 
+// Draw layers, from back to front (see RenderQueue)
+enum layer : uint8_t {backgroundLayer, borderLayer, mountainLayer, farTargetLayer, midTargetLayer, nearTargetLayer, userLayer, bonusLayer, textLayer};
+// GPU pass name of each layer (same order as the enum above)
+const vector<string> layerNames = {"background", "borders", "mountains", "far targets", "mid targets", "near targets",
+                                   "user", "bonus box", "text"};
+
 //Tracker-related variables
 bool gameStarted = false;
 int startTime = 0;
@@ -36,14 +45,26 @@ const color orange(1, 163/255.0, 22/255.0);
 const color cyan (0, 1, 1);
 const color yellow (1, 1, 0);
 const color gold (238/255.0, 232/255.0, 170/255.0);
+const color shadow (0, 0, 0, 0.25);
 
-Engine::Engine() : keys() {
-    this->initWindow();
+Engine::Engine(HeadlessOptions headless) : headless(std::move(headless)), keys(), previousKeys() {
+    if (this->headless.enabled) {
+        if (this->initHeadless() != 0)
+            exit(EXIT_FAILURE);
+    } else {
+        this->initWindow();
+    }
     this->initShaders();
     this->initShapes();
+    this->initBackgrounds();
+
+    overdrawView = this->headless.overdraw;
+    renderQueue->setDepthOrdering(this->headless.depthOrdering);
 }
 
-Engine::~Engine() {}
+Engine::~Engine() {
+    GeometryCache::clear();
+}
 
 unsigned int Engine::initWindow(bool debug) {
     // glfw: initialize and configure
@@ -57,6 +78,9 @@ unsigned int Engine::initWindow(bool debug) {
     glfwWindowHint(GLFW_COCOA_RETINA_FRAMEBUFFER, GLFW_FALSE);
 #endif
     glfwWindowHint(GLFW_RESIZABLE, false);
+    // Depth for the front-to-back opaque pass, stencil for the overdraw view
+    glfwWindowHint(GLFW_DEPTH_BITS, 24);
+    glfwWindowHint(GLFW_STENCIL_BITS, 8);
 
     window = glfwCreateWindow(width, height, "engine", nullptr, nullptr);
     glfwMakeContextCurrent(window);
@@ -71,25 +95,111 @@ unsigned int Engine::initWindow(bool debug) {
     glViewport(0, 0, width, height);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Draws in the same layer share a depth, so later ones must still pass
+    glDepthFunc(GL_LEQUAL);
     glfwSwapInterval(1);
 
     return 0;
 }
 
+unsigned int Engine::initHeadless() {
+    headlessContext = make_unique<HeadlessContext>(width, height);
+    if (!headlessContext->init())
+        return -1;
+
+    // OpenGL configuration (same as the window)
+    glViewport(0, 0, width, height);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDepthFunc(GL_LEQUAL);
+
+    // Nothing can press 's', so start on the requested level (anything else would leave screen outside the enum)
+    if (headless.level >= level1 && headless.level <= level4) {
+        screen = static_cast<state>(headless.level);
+        gameStarted = true;
+        startTime = getTime();
+    }
+
+    return 0;
+}
+
+double Engine::getTime() const {
+    if (headless.enabled)
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - startClock).count();
+    return glfwGetTime();
+}
+
+const GpuProfiler &Engine::getGpuProfiler() const {
+    return *gpuProfiler;
+}
+
 void Engine::initShaders() {
     // load shader manager
     shaderManager = make_unique<ShaderManager>();
 
-    // Load shader into shader manager and retrieve it
-    shapeShader = this->shaderManager->loadShader("../res/shaders/shape.vert", "../res/shaders/shape.frag",  nullptr, "shape");
+    // Start compiling every shader at once, so the driver can work on them in parallel
+    shaderManager->queueShader("shaders/shape.vert", "shaders/shape.frag",  nullptr, "shape");
+    // The glyphs are signed distance fields, so one small atlas stays crisp at every scale (e.g. the .5 mode label)
+    shaderManager->queueShader("shaders/text.vert", "shaders/textSdf.frag", nullptr, "text");
+    // Target layers
+    shaderManager->queueShader("shaders/instanced.vert", "shaders/instanced.frag", nullptr, "instanced");
+    // Circles reuse the instanced vertex shader; circle.frag turns each quad into a circle
+    shaderManager->queueShader("shaders/instanced.vert", "shaders/circle.frag", nullptr, "circle");
+    // Mountains use a vertex shader that scrolls (and wraps) the whole layer
+    shaderManager->queueShader("shaders/scenery.vert", "shaders/instanced.frag", nullptr, "scenery");
+
+    // Keep the window alive with a loading frame until they are linked (headless runs just wait)
+    if (headless.enabled) {
+        shaderManager->finishShaders(true);
+    } else {
+        while (!shaderManager->finishShaders())
+            drawLoadingFrame(shaderManager->getProgress());
+    }
+    shapeShader = shaderManager->getShader("shape");
+    textShader = shaderManager->getShader("text");
+
+    // Configure text renderer
+    fontRenderer = make_unique<FontRenderer>(shaderManager->getShader("text"), "fonts/MxPlus_IBM_BIOS.ttf", 24, GlyphMode::SDF);
+
+    // Configure instanced renderers
+    rectRenderer = make_unique<InstancedRenderer>(shaderManager->getShader("instanced"));
+    circleRenderer = make_unique<InstancedRenderer>(shaderManager->getShader("circle"));
+    mountainRenderer = make_unique<InstancedRenderer>(shaderManager->getShader("scenery"), ShapeKind::Triangle);
+
+    // The calling (GL) thread records too, so one worker per extra core
+    unsigned int cores = std::thread::hardware_concurrency();
+    workers = make_unique<WorkerPool>(cores > 1 ? cores - 1 : 0);
+    renderQueue = make_unique<RenderQueue>(workers.get());
+
+    // Time each queue layer and every renderText() call on the GPU
+    gpuProfiler = make_unique<GpuProfiler>();
+    renderQueue->setProfiler(gpuProfiler.get(), layerNames);
+    fontRenderer->setProfiler(gpuProfiler.get());
 
-    // Configure text shader and renderer
-    textShader = shaderManager->loadShader("../res/shaders/text.vert", "../res/shaders/text.frag", nullptr, "text");
-    fontRenderer = make_unique<FontRenderer>(shaderManager->getShader("text"), "../res/fonts/MxPlus_IBM_BIOS.ttf", 24);
+    textMeshCache = make_unique<TextMeshCache>(*fontRenderer);
+
+    // Every program reads the projection from the shared frame block, filled here already for the background bakes
+    frameUniforms = make_unique<FrameUniforms>();
+    frameUniforms->update({this->PROJECTION, vec2(width, height), 0.0f, 0.0f});
 
     // Set uniforms that never change
-    shapeShader.use();
-    shapeShader.setMatrix4("projection", this->PROJECTION);
+    Shader &scenery = shaderManager->getShader("scenery");
+    scrollLocation = scenery.getUniformLocation("scroll");
+    scenery.use().setVector2f(scenery.getUniformLocation("wrap"), vec2(MOUNTAIN_MARGIN, width + 2 * MOUNTAIN_MARGIN));
+}
+
+void Engine::drawLoadingFrame(float progress) {
+    // Scissored clears draw the progress bar without needing any of the shaders that are still compiling
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(width / 4, height / 2 - 5, static_cast<GLsizei>(width / 2 * progress), 10);
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDisable(GL_SCISSOR_TEST);
+
+    glfwSwapBuffers(window);
+    glfwPollEvents();
 }
 
 void Engine::initShapes() {
@@ -99,6 +209,8 @@ void Engine::initShapes() {
     //bonusBox is a 35x35 yellow box that flies across the screen
     bonusBox = make_unique<Rect>(shapeShader, vec2(-20, 300), vec2(35, 35), yellow); // placeholder for compilation
 
+    overdrawRect = make_unique<Rect>(shapeShader, vec2(width/2, height/2), vec2(width, height), black);
+
     // Init level1 background
     grass1 = make_unique<Rect>(shapeShader, vec2(width/2, 50), vec2(width, height * 2), black);
     bottomBorder1 = make_unique<Rect>(shapeShader, vec2(width/2, 0), vec2(width, height/3), grey);
@@ -161,30 +273,90 @@ void Engine::initShapes() {
                                              targetSize, purple));
         totalTargetWidth += targetSize.x + 5;
     }
+
+    // Round targets ride with the near row and are hit by radius (see shootCircles())
+    for (int i = 0; i < ROUND_TARGET_COUNT; ++i) {
+        float radius = rand() % 11 + 15;
+        circles.push_back(make_unique<Circle>(shaderManager->getShader("circle"),
+                                              vec2((i + 0.5f) * width / ROUND_TARGET_COUNT, rand() % 200 + 200),
+                                              radius, brickRed));
+    }
+
+    // Mountain range standing on the bottom border, a few pixels apart so the silhouettes overlap.
+    // Translucent so it darkens every level's background instead of needing a color per level.
+    // Restarts call this again, so the old range is replaced rather than stacked under the new one.
+    mountains.clear();
+    for (float x = -MOUNTAIN_MARGIN; x < width + MOUNTAIN_MARGIN; x += 3) {
+        vec2 mountainSize(rand() % 81 + 40, rand() % 121 + 40);
+        mountains.push_back(make_unique<Triangle>(shapeShader, vec2(x, height/6 + mountainSize.y / 2),
+                                                  mountainSize, shadow));
+    }
+
+    // Scrolling moves every mountain, so the whole range is damaged at once (see trackDamage())
+    mountainBand = vec4(0, height/6, width, height/6);
+    for (const unique_ptr<Triangle>& m : mountains)
+        mountainBand.w = std::max(mountainBand.w, m->getTop());
+    // "BONUS BOX!" and "Mode:" sit at y = 510, "Score:" at y = 540 (with room for descenders and a 24px font)
+    hudBand = vec4(0, 500, width, 570);
+}
+
+
+void Engine::initBackgrounds() {
+    scene = make_unique<SceneBuffer>(width, height);
+    damage = make_unique<DamageTracker>(width, height);
+
+    backgrounds.clear();
+    bakeBackground(*grass1, *bottomBorder1, *topBorder1);
+    bakeBackground(*grass2, *bottomBorder2, *topBorder2);
+    bakeBackground(*grass3, *bottomBorder3, *topBorder3);
+    bakeBackground(*grass4, *bottomBorder4, *topBorder4);
+}
+
+void Engine::bakeBackground(const Rect &grass, const Rect &bottomBorder, const Rect &topBorder) {
+    unique_ptr<StaticLayer> background = make_unique<StaticLayer>(width, height);
+    background->beginBake(skyBlue.vec);
+    renderQueue->submit(backgroundLayer, grass);
+    renderQueue->submit(borderLayer, bottomBorder);
+    renderQueue->submit(borderLayer, topBorder);
+    renderQueue->flush();
+    background->endBake();
+    backgrounds.push_back(std::move(background));
 }
 
 
 void Engine::processInput() {
-    glfwPollEvents();
+    bool mousePressed = false;
+
+    // Without a window there is nothing to poll: keys stay released and the mouse stays put
+    if (!headless.enabled) {
+        glfwPollEvents();
+
+        // Set keys to true if pressed, false if released
+        for (int key = 0; key < 1024; ++key) {
+            previousKeys[key] = keys[key];
+            if (glfwGetKey(window, key) == GLFW_PRESS)
+                keys[key] = true;
+            else if (glfwGetKey(window, key) == GLFW_RELEASE)
+                keys[key] = false;
+        }
 
-    // Set keys to true if pressed, false if released
-    for (int key = 0; key < 1024; ++key) {
-        if (glfwGetKey(window, key) == GLFW_PRESS)
-            keys[key] = true;
-        else if (glfwGetKey(window, key) == GLFW_RELEASE)
-            keys[key] = false;
-    }
+        // Close window if escape key is pressed
+        if (keys[GLFW_KEY_ESCAPE])
+            glfwSetWindowShouldClose(window, true);
 
-    // Close window if escape key is pressed
-    if (keys[GLFW_KEY_ESCAPE])
-        glfwSetWindowShouldClose(window, true);
+        // F1 shows the overdraw heat map, F2 switches between front-to-back and back-to-front drawing
+        if (keyPressed(GLFW_KEY_F1))
+            overdrawView = !overdrawView;
+        if (keyPressed(GLFW_KEY_F2))
+            renderQueue->setDepthOrdering(!renderQueue->getDepthOrdering());
 
-    // Mouse position saved to check for collisions
-    glfwGetCursorPos(window, &MouseX, &MouseY);
+        // Mouse position saved to check for collisions
+        glfwGetCursorPos(window, &MouseX, &MouseY);
 
-    // Update mouse rect to follow mouse
-    MouseY = height - MouseY; // make sure mouse y-axis isn't flipped
-    bool mousePressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        // Update mouse rect to follow mouse
+        MouseY = height - MouseY; // make sure mouse y-axis isn't flipped
+        mousePressed = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+    }
 
     // User moving with the mouse
     user->setPosX(MouseX);
@@ -194,7 +366,7 @@ void Engine::processInput() {
     if (screen == start && keys[GLFW_KEY_S]) {
         screen = level1;
         gameStarted = true;
-        startTime = glfwGetTime();
+        startTime = getTime();
     }
 
     // Level 1 Controls
@@ -573,6 +745,9 @@ void Engine::processInput() {
         }
     }
 
+    if (screen >= level1 && screen <= level4)
+        shootCircles(mousePressedLastFrame && !mousePressed);
+
     //restart function
     if (screen == over) {
         if (keys[GLFW_KEY_H]) {
@@ -583,97 +758,41 @@ void Engine::processInput() {
         }
         if (keys[GLFW_KEY_R]) {
             if (currentLevel == "1") {
-                targets1.clear();
-                targets2.clear();
-                targets3.clear();
-                this->initShapes();
-                score = 0;
-                shotsTaken = 0;
-                shotsHit = 0;
-                clicks = 0;
+                resetRound();
                 screen = level1;
             } else if (currentLevel == "2") {
-                targets1.clear();
-                targets2.clear();
-                targets3.clear();
-                this->initShapes();
-                score = 0;
-                shotsTaken = 0;
-                shotsHit = 0;
-                clicks = 0;
+                resetRound();
                 screen = level2;
             } else if (currentLevel == "3") {
-                targets1.clear();
-                targets2.clear();
-                targets3.clear();
-                this->initShapes();
-                score = 0;
-                shotsTaken = 0;
-                shotsHit = 0;
-                clicks = 0;
+                resetRound();
                 screen = level3;
             } else if (currentLevel == "4") {
-                targets1.clear();
-                targets2.clear();
-                targets3.clear();
-                this->initShapes();
-                score = 0;
-                shotsTaken = 0;
-                shotsHit = 0;
-                clicks = 0;
+                resetRound();
                 screen = level4;
             } else {
                 screen = level1;
             }
         }
         if (keys[GLFW_KEY_1]) {
-            targets1.clear();
-            targets2.clear();
-            targets3.clear();
-            this->initShapes();
 //            bonusBox->setPosX(-20);
 //            bonusBox->setPosY(300);
-            score = 0;
-            shotsTaken = 0;
-            shotsHit = 0;
-            clicks = 0;
+            resetRound();
             screen = level1;
         }
         if (keys[GLFW_KEY_2]) {
-            targets1.clear();
-            targets2.clear();
-            targets3.clear();
-            this->initShapes();
 //            bonusBox->setPosX(400);
 //            bonusBox->setPosY(620);
-            score = 0;
-            shotsTaken = 0;
-            shotsHit = 0;
-            clicks = 0;
+            resetRound();
             screen = level2;
         }
         if (keys[GLFW_KEY_3]) {
-            targets1.clear();
-            targets2.clear();
-            targets3.clear();
-            this->initShapes();
             //bonusBox->setPosX(-20);
-            score = 0;
-            shotsTaken = 0;
-            shotsHit = 0;
-            clicks = 0;
+            resetRound();
             screen = level3;
         }
         if (keys[GLFW_KEY_4]) {
-            targets1.clear();
-            targets2.clear();
-            targets3.clear();
-            this->initShapes();
             //bonusBox->setPosX(-20);
-            score = 0;
-            shotsTaken = 0;
-            shotsHit = 0;
-            clicks = 0;
+            resetRound();
             screen = level4;
         }
     }
@@ -690,14 +809,20 @@ void Engine::processInput() {
 
 void Engine::update() {
     // Calculate delta time
-    float currentFrame = glfwGetTime();
+    float currentFrame = getTime();
     deltaTime = currentFrame - lastFrame;
     lastFrame = currentFrame;
 
+    // Drift the mountains (wrapped here too, so the float never loses precision)
+    mountainScroll = fmod(mountainScroll + MOUNTAIN_SPEED * deltaTime, width + 2 * MOUNTAIN_MARGIN);
+
     if (gameStarted && screen == over && endTime == 0) {
         endTime = currentFrame;
     }
 
+    if (screen >= level1 && screen <= level4)
+        updateCircles();
+
     // Update targets (level 1)
     if (screen == level1) {
 //        if (score > 9 && score < 12) {
@@ -976,280 +1101,299 @@ void Engine::update() {
     }
 }
 
-void Engine::render() {
-    glClearColor(skyBlue.red,skyBlue.green, skyBlue.blue, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
-
-    // Set shader to use for all shapes
-    shapeShader.use();
-
-    // Render differently depending on screen
+vec2 Engine::nearTargetStep() const {
+    // The same per-frame steps the near (red) targets take in update()
     switch (screen) {
-        case start: {
-            string message = "Press s to start!";
-            // (12 * message.length()) is the offset to center text.
-            // 12 pixels is the width of each character scaled by 1.
-            // Game instructions
-            this->fontRenderer->renderText(message, width/2 - (12 * message.length()), 100, 1, vec3{1, 0, 0});
-            string instMessage = "How to Play:";
-            this->fontRenderer->renderText(instMessage, width/2 - (12 * instMessage.length()), 500, 1, vec3{1, 1, 1});
-            instMessage = "Targets are flying around!";
-            this->fontRenderer->renderText(instMessage, width/2 - (12 * instMessage.length()), 450, 1, vec3{1, 1, 1});
-            instMessage = "When you click on a target, it";
-            this->fontRenderer->renderText(instMessage, width/2 - (12 * instMessage.length()), 400, 1, vec3{1, 1, 1});
-            instMessage = "will pop. Targets will move at";
-            this->fontRenderer->renderText(instMessage, width/2 - (12 * instMessage.length()), 350, 1, vec3{1, 1, 1});
-            instMessage = "different speeds and are";
-            this->fontRenderer->renderText(instMessage, width/2 - (12 * instMessage.length()), 300, 1, vec3{1, 1, 1});
-            instMessage = "different shapes and sizes.";
-            this->fontRenderer->renderText(instMessage, width/2 - (12 * instMessage.length()), 250, 1, vec3{1, 1, 1});
-            instMessage = "Try to be accurate!";
-            this->fontRenderer->renderText(instMessage, width/2 - (12 * instMessage.length()), 200, 1, vec3{1, 1, 1});
-            instMessage = "Good luck!";
-            this->fontRenderer->renderText(instMessage, width/2 - (12 * instMessage.length()), 150, 1, vec3{1, 1, 1});
-            break;
-        }
-        case level1: {
-            grass1->setUniforms();
-            grass1->draw();
-
-            bottomBorder1->setUniforms();
-            bottomBorder1->draw();
-
-            topBorder1->setUniforms();
-            topBorder1->draw();
-
-            for (const auto& b  : targets3) {
-                b->setUniforms();
-                b->draw();
-            }
-
-            for (const auto& b : targets2) {
-                b->setUniforms();
-                b->draw();
-            }
+        case level1: return hardMode ? vec2(-4, 0) : vec2(-1.5, 0);
+        case level2: return hardMode ? vec2(0, -3) : vec2(0, -1.5);
+        case level3: return hardMode ? vec2(-3, -3) : vec2(-1.5, -1.5);
+        case level4: return vec2(1.5, -1.5);
+        default:     return vec2(0, 0);
+    }
+}
 
-            for (const auto& b : targets1) {
-                b->setUniforms();
-                b->draw();
-            }
+void Engine::resetRound() {
+    targets1.clear();
+    targets2.clear();
+    targets3.clear();
+    circles.clear();
+    this->initShapes();
+    score = 0;
+    shotsTaken = 0;
+    shotsHit = 0;
+    clicks = 0;
+}
 
-            user->setUniforms();
-            user->draw();
+void Engine::updateCircles() {
+    vec2 step = nearTargetStep();
+    for (const unique_ptr<Circle>& c : circles) {
+        c->moveX(step.x);
+        c->moveY(step.y);
+        // Wrap around to the other side of the screen so it passes through again
+        float radius = c->getRadius();
+        if (c->getRight() < 0)
+            c->setPosX(width + radius);
+        else if (c->getLeft() > width)
+            c->setPosX(-radius);
+        if (c->getTop() < 0)
+            c->setPosY(height + radius);
+        else if (c->getBottom() > height)
+            c->setPosY(-radius);
+    }
+}
 
-            bonusBox->setUniforms();
-            bonusBox->draw();
+void Engine::shootCircles(bool shot) {
+    vec2 step = nearTargetStep();
+    for (const unique_ptr<Circle>& c : circles) {
+        // Hit by radius, so clicking the corners of its bounding box misses
+        if (!c->contains(vec2(MouseX, MouseY))) {
+            c->setColor(brickRed);
+            continue;
+        }
+        c->setColor(orange);
+        if (!shot)
+            continue;
+        // Level 1 already counted the click
+        if (screen != level1)
+            shotsTaken++;
+        shotsHit++;
+        score++;
+        // Send it back to where the row comes in from
+        float radius = c->getRadius();
+        if (step.x != 0)
+            c->setPosX(step.x < 0 ? width + radius : -radius);
+        else
+            c->setPosY(step.y < 0 ? height + radius : -radius);
+    }
+}
 
-            //bonusBox popup
-            string bbMessage;
-            bbMessage = "BONUS BOX!";
-            while (bonusBox->getLeft() > 0 && bonusBox->getRight() < 800) {
-                this->fontRenderer->renderText(bbMessage, width/2 - (12 * bbMessage.length()), 510, 1, vec3{1, 1, 1});
-            }
+void Engine::render() {
+    // State-change counters and GPU timings are per frame
+    GLState::resetStats();
+    gpuProfiler->beginFrame();
+    gpuProfiler->begin("frame");
+
+    // One upload of the per-frame constants covers every draw of the frame
+    frameUniforms->update({this->PROJECTION, vec2(width, height), static_cast<float>(getTime()), 0.0f});
+
+    // Redraw only what changed; the rest of the frame is still in the scene buffer
+    trackDamage();
+    if (!damage->isEmpty())
+        redraw();
+
+    // The scene buffer always holds the whole frame
+    gpuProfiler->begin("scene blit");
+    scene->blitTo(getScreenFramebuffer());
+    gpuProfiler->end();
+    gpuProfiler->end();
+
+    // Meshes of blocks that are gone (an old score, a screen we left) are freed after a while
+    textMeshCache->endFrame();
+    fontRenderer->endFrame();
+
+    present();
+}
 
-            //Live score tracker
-            stringstream ss;
-            ss << score;
-            string message = ss.str();
-            ss << message;
-            string ptTracker = "Score: " + message;
-            this->fontRenderer->renderText(ptTracker, width/2 - (12 * ptTracker.length()), 540, 1, vec3{1, 1, 1});
-            string hardM = "Mode: " + hard;
-            this->fontRenderer->renderText(hardM, 30, 510, .5, vec3{1, 1, 1});
-            break;
-        }
-        case level2: {
-            grass2->setUniforms();
-            grass2->draw();
+void Engine::trackDamage() {
+    damage->reset();
 
-            bottomBorder2->setUniforms();
-            bottomBorder2->draw();
+    // The overdraw view paints over the whole scene, so it (and leaving it) needs full redraws
+    if (screen != drawnScreen || overdrawView || overdrawView != drawnOverdrawView)
+        damage->invalidate();
+    drawnScreen = screen;
+    drawnOverdrawView = overdrawView;
 
-            topBorder2->setUniforms();
-            topBorder2->draw();
+    if (screen == start || screen == over)
+        return;
 
-            for (const auto& b  : targets3) {
-                b->setUniforms();
-                b->draw();
-            }
+    damage->track(targets1);
+    damage->track(targets2);
+    damage->track(targets3);
+    damage->track(circles);
+    damage->track(*user);
+    damage->track(*bonusBox);
 
-            for (const auto& b : targets2) {
-                b->setUniforms();
-                b->draw();
-            }
+    if (mountainScroll != drawnMountainScroll) {
+        damage->add(mountainBand);
+        drawnMountainScroll = mountainScroll;
+    }
 
-            for (const auto& b : targets1) {
-                b->setUniforms();
-                b->draw();
-            }
+    bool bonusPopup = isBonusPopupVisible();
+    if (score != drawnScore || hard != drawnMode || bonusPopup != drawnBonusPopup) {
+        damage->add(hudBand);
+        drawnScore = score;
+        drawnMode = hard;
+        drawnBonusPopup = bonusPopup;
+    }
+}
 
-            user->setUniforms();
-            user->draw();
+void Engine::redraw() {
+    scene->bind();
 
-            bonusBox->setUniforms();
-            bonusBox->draw();
+    // Clears, blits and draws are all clipped by the scissor
+    if (!damage->isFull()) {
+        ivec4 box = damage->getScissor();
+        glEnable(GL_SCISSOR_TEST);
+        glScissor(box.x, box.y, box.z, box.w);
+    }
 
-            //bonusBox popup
-            string bbMessage;
-            bbMessage = "BONUS BOX!";
-            while (bonusBox->getLeft() > 0 && bonusBox->getRight() < 800) {
-                this->fontRenderer->renderText(bbMessage, width/2 - (12 * bbMessage.length()), 510, 1, vec3{1, 1, 1});
-            }
+    // Level screens restore a baked background that covers every pixel, so only the other screens clear the color.
+    // Depth and stencil are always cleared (they share a buffer, and clearing them is nearly free).
+    bool levelScreen = screen != start && screen != over;
+    GLbitfield clearMask = GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT;
+    if (!levelScreen) {
+        glClearColor(skyBlue.red,skyBlue.green, skyBlue.blue, 1.0f);
+        clearMask |= GL_COLOR_BUFFER_BIT;
+    }
+    // The background blit writes every pixel once, so the overdraw count starts at 1 on levels
+    glClearStencil(levelScreen ? 1 : 0);
+    glClear(clearMask);
+
+    // Count every fragment that passes the depth test
+    if (overdrawView) {
+        glEnable(GL_STENCIL_TEST);
+        glStencilFunc(GL_ALWAYS, 0, 0xFF);
+        glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+    }
 
-            //Live score tracker
-            stringstream ss;
-            ss << score;
-            string message = ss.str();
-            ss << message;
-            string ptTracker = "Score: " + message;
-            this->fontRenderer->renderText(ptTracker, width/2 - (12 * ptTracker.length()), 540, 1, vec3{1, 1, 1});
-            string hardM = "Mode: " + hard;
-            this->fontRenderer->renderText(hardM, 30, 510, .5, vec3{1, 1, 1});
+    // Queue everything for the current screen; the render queue decides the draw order
+    switch (screen) {
+        case start: {
+            // The instructions never change, so after the first frame this is one cached draw
+            textLines.clear();
+            textLines.push_back(centeredLine("Press s to start!", 100, vec3{1, 0, 0}));
+            textLines.push_back(centeredLine("How to Play:", 500, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("Targets are flying around!", 450, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("When you click on a target, it", 400, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("will pop. Targets will move at", 350, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("different speeds and are", 300, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("different shapes and sizes.", 250, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("Try to be accurate!", 200, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("Good luck!", 150, vec3{1, 1, 1}));
+            renderQueue->submitTextMesh(textLayer, *textMeshCache, textMeshCache->get(textLines));
             break;
         }
-        case level3: {
-            grass3->setUniforms();
-            grass3->draw();
-
-            bottomBorder3->setUniforms();
-            bottomBorder3->draw();
-
-            topBorder3->setUniforms();
-            topBorder3->draw();
-
-            for (const auto& b  : targets3) {
-                b->setUniforms();
-                b->draw();
-            }
-
-            for (const auto& b : targets2) {
-                b->setUniforms();
-                b->draw();
-            }
-
-            for (const auto& b : targets1) {
-                b->setUniforms();
-                b->draw();
-            }
-
-            user->setUniforms();
-            user->draw();
-
-            bonusBox->setUniforms();
-            bonusBox->draw();
-
-            //bonusBox popup
-            string bbMessage;
-            bbMessage = "BONUS BOX!";
-            while (bonusBox->getLeft() > 0 && bonusBox->getRight() < 800) {
-                this->fontRenderer->renderText(bbMessage, width/2 - (12 * bbMessage.length()), 510, 1, vec3{1, 1, 1});
-            }
-
-            //Live score tracker
+        case level1:
+            submitLevel(*backgrounds[0]);
+            break;
+        case level2:
+            submitLevel(*backgrounds[1]);
+            break;
+        case level3:
+            submitLevel(*backgrounds[2]);
+            break;
+        case level4:
+            submitLevel(*backgrounds[3]);
+            break;
+        case over: {
+            int totalTime = endTime - startTime;
             stringstream ss;
-            ss << score;
-            string message = ss.str();
-            ss << message;
-            string ptTracker = "Score: " + message;
-            this->fontRenderer->renderText(ptTracker, width/2 - (12 * ptTracker.length()), 540, 1, vec3{1, 1, 1});
-            string hardM = "Mode: " + hard;
-            this->fontRenderer->renderText(hardM, 30, 510, .5, vec3{1, 1, 1});
+            ss << accuracy;
+            textLines.clear();
+            textLines.push_back(centeredLine("You win!", 540, vec3{1, 1, 0}));
+            textLines.push_back(centeredLine("It took you...", 460, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine(std::to_string(totalTime), 407, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("seconds and", 355, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine(std::to_string(clicks), 300, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("clicks to hit all targets!", 260, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("Accuracy: " + ss.str() + "%", 220, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("Press 'r' to replay, or", 150, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("press '1' '2' '3' or '4'", 120, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("to jump to that level!", 90, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("Press 'h' to enter hardmode!", 60, vec3{1, 1, 1}));
+            textLines.push_back(centeredLine("Press 'n' to exit hardmode!", 30, vec3{1, 1, 1}));
+            renderQueue->submitTextMesh(textLayer, *textMeshCache, textMeshCache->get(textLines));
             break;
         }
-        case level4: {
-            grass4->setUniforms();
-            grass4->draw();
+    }
 
-            bottomBorder4->setUniforms();
-            bottomBorder4->draw();
+    // Sort and draw everything queued above
+    renderQueue->flush();
+    if (overdrawView)
+        drawOverdraw();
 
-            topBorder4->setUniforms();
-            topBorder4->draw();
+    glDisable(GL_SCISSOR_TEST);
+}
 
-            for (const auto& b  : targets3) {
-                b->setUniforms();
-                b->draw();
-            }
+unsigned int Engine::getScreenFramebuffer() const {
+    return headless.enabled ? headlessContext->getFramebuffer() : 0;
+}
 
-            for (const auto& b : targets2) {
-                b->setUniforms();
-                b->draw();
-            }
+bool Engine::isBonusPopupVisible() const {
+    return bonusBox->getLeft() > 0 && bonusBox->getRight() < 800;
+}
 
-            for (const auto& b : targets1) {
-                b->setUniforms();
-                b->draw();
-            }
+bool Engine::keyPressed(int key) const {
+    return keys[key] && !previousKeys[key];
+}
 
-            user->setUniforms();
-            user->draw();
+void Engine::drawOverdraw() {
+    // Heat color of each count; the last one is used for that count and anything above it
+    const vector<color> heat = {black, color(0, 0, 0.8), color(0, 0.7, 0), yellow, orange, color(1, 0, 0)};
+
+    glDisable(GL_DEPTH_TEST);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    GLState::useProgram(shapeShader.ID);
+    for (size_t count = 0; count < heat.size(); ++count) {
+        // GL_LEQUAL passes where count <= stencil value
+        glStencilFunc(count + 1 == heat.size() ? GL_LEQUAL : GL_EQUAL, static_cast<GLint>(count), 0xFF);
+        overdrawRect->setColor(heat[count]);
+        overdrawRect->setUniforms();
+        overdrawRect->draw();
+    }
+    glDisable(GL_STENCIL_TEST);
+}
 
-            bonusBox->setUniforms();
-            bonusBox->draw();
+void Engine::present() {
+    frameCount++;
+    if (!headless.enabled) {
+        glfwSwapBuffers(window);
+        return;
+    }
 
-            //bonusBox popup
-            string bbMessage;
-            bbMessage = "BONUS BOX!";
-            while (bonusBox->getLeft() > 0 && bonusBox->getRight() < 800) {
-                this->fontRenderer->renderText(bbMessage, width/2 - (12 * bbMessage.length()), 510, 1, vec3{1, 1, 1});
-            }
+    if (frameCount == headless.frames && !headless.capturePath.empty())
+        headlessContext->capture(headless.capturePath);
+    headlessContext->present();
+}
 
-            //Live score tracker
-            stringstream ss;
-            ss << score;
-            string message = ss.str();
-            ss << message;
-            string ptTracker = "Score: " + message;
-            this->fontRenderer->renderText(ptTracker, width/2 - (12 * ptTracker.length()), 540, 1, vec3{1, 1, 1});
-            string hardM = "Mode: " + hard;
-            this->fontRenderer->renderText(hardM, 30, 510, .5, vec3{1, 1, 1});
-            break;
-        }
-        case over: {
-            int totalTime = endTime - startTime;
-            stringstream ss;
-            ss << totalTime;
-            string message = "You win!";
-            // Displays the message on the screen
-            this->fontRenderer->renderText(message, width/2 - (12 * message.length()), 540, 1, vec3{1, 1, 0});
-            string timeText = "It took you...";
-            this->fontRenderer->renderText(timeText, width/2 - (12 * timeText.length()), 460, 1, vec3{1, 1, 1});
-            string timeResult = " ";
-            ss >> timeResult;
-            this->fontRenderer->renderText(timeResult, width/2 - (12 * timeResult.length()), 407, 1, vec3{1, 1, 1});
-            string timeQ = "seconds and";
-            this->fontRenderer->renderText(timeQ, width/2 - (12 * timeQ.length()), 355, 1, vec3{1, 1, 1});
-            stringstream ss2;
-            ss2 << clicks;
-            string clix = "";
-            ss2 >> clix;
-            this->fontRenderer->renderText(clix, width/2 - (12 * clix.length()), 300, 1, vec3{1, 1, 1});
-            string postClix = "clicks to hit all targets!";
-            this->fontRenderer->renderText(postClix, width/2 - (12 * postClix.length()), 260, 1, vec3{1, 1, 1});
-            stringstream ss1;
-            ss1 << accuracy;
-            string aim = "";
-            ss1 >> aim;
-            string accResult = "Accuracy: " + aim + "%";
-            this->fontRenderer->renderText(accResult, width/2 - (12 * accResult.length()), 220, 1, vec3{1, 1, 1});
-            string restart = "Press 'r' to replay, or";
-            this->fontRenderer->renderText(restart, width/2 - (12 * restart.length()), 150, 1, vec3{1, 1, 1});
-            string levels = "press '1' '2' '3' or '4'";
-            this->fontRenderer->renderText(levels, width/2 - (12 * levels.length()), 120, 1, vec3{1, 1, 1});
-            string levels2 = "to jump to that level!";
-            this->fontRenderer->renderText(levels2, width/2 - (12 * levels2.length()), 90, 1, vec3{1, 1, 1});
-            string hardmode = "Press 'h' to enter hardmode!";
-            this->fontRenderer->renderText(hardmode, width/2 - (12 * hardmode.length()), 60, 1, vec3{1, 1, 1});
-            string hardmodeOff = "Press 'n' to exit hardmode!";
-            this->fontRenderer->renderText(hardmodeOff, width/2 - (12 * hardmodeOff.length()), 30, 1, vec3{1, 1, 1});
-            break;
-        }
-    }
+void Engine::submitLevel(const StaticLayer &background) {
+    // A single blit instead of a clear and three full-width rects
+    gpuProfiler->begin("background blit");
+    background.restore();
+    gpuProfiler->end();
+
+    // The whole mountain range in one instanced draw (scrolled by the shader)
+    shaderManager->getShader("scenery").use().setFloat(scrollLocation, mountainScroll);
+    renderQueue->submit(mountainLayer, *mountainRenderer, mountains);
+
+    // One instanced draw per target layer, furthest layer first
+    // The rects are opaque, so they are drawn front to back and hide what is behind them from the shader
+    renderQueue->submit(farTargetLayer, *rectRenderer, targets3, true);
+    renderQueue->submit(midTargetLayer, *rectRenderer, targets2, true);
+    renderQueue->submit(nearTargetLayer, *rectRenderer, targets1, true);
+    // Circles blend their antialiased edges, so they stay in the back-to-front pass
+    renderQueue->submit(nearTargetLayer, *circleRenderer, circles);
+
+    renderQueue->submit(userLayer, *user, true);
+    renderQueue->submit(bonusLayer, *bonusBox, true);
+
+    // The HUD is one cached block, rebuilt only when the score, mode or popup changes
+    textLines.clear();
+    if (isBonusPopupVisible())
+        textLines.push_back(centeredLine("BONUS BOX!", 510, vec3{1, 1, 1}));
+    textLines.push_back(centeredLine("Score: " + std::to_string(score), 540, vec3{1, 1, 1}));
+    textLines.push_back({"Mode: " + hard, 30, 510, .5, vec3{1, 1, 1}});
+    renderQueue->submitTextMesh(textLayer, *textMeshCache, textMeshCache->get(textLines));
+}
 
-    glfwSwapBuffers(window);
+TextLine Engine::centeredLine(const string &text, float y, vec3 color) const {
+    // 12 pixels is half the width of a character scaled by 1
+    return {text, width/2 - (12.0f * text.length()), y, 1, color};
 }
 
 bool Engine::shouldClose() {
+    if (headless.enabled)
+        return frameCount >= headless.frames;
     return glfwWindowShouldClose(window);
 }
 
@@ -1,12 +1,25 @@
 #ifndef GRAPHICS_ENGINE_H
 #define GRAPHICS_ENGINE_H
 
+#include <chrono>
 #include <vector>
 #include <memory>
+#include <string>
 #include <GLFW/glfw3.h>
 
 #include "shader/shaderManager.h"
 #include "font/fontRenderer.h"
+#include "font/textMeshCache.h"
+#include "renderer/instancedRenderer.h"
+#include "renderer/glState.h"
+#include "renderer/renderQueue.h"
+#include "renderer/workerPool.h"
+#include "renderer/gpuProfiler.h"
+#include "renderer/frameUniforms.h"
+#include "renderer/staticLayer.h"
+#include "renderer/sceneBuffer.h"
+#include "renderer/damageTracker.h"
+#include "platform/headlessContext.h"
 #include "shapes/rect.h"
 #include "shapes/circle.h"
 #include "shapes/shape.h"
@@ -14,6 +27,22 @@
 
 using std::vector, std::unique_ptr, std::make_unique, glm::ortho, glm::mat4, glm::vec3, glm::vec4;
 
+/// @brief Options for running the engine without a window (see HeadlessContext).
+struct HeadlessOptions {
+    /// @brief Render offscreen through EGL instead of opening a GLFW window
+    bool enabled = false;
+    /// @brief Number of frames to render before shouldClose() returns true
+    unsigned int frames = 600;
+    /// @brief Level to start on (1-4), since there is no keyboard to press 's'
+    int level = 1;
+    /// @brief If not empty, the last frame is written to this PPM file
+    std::string capturePath;
+    /// @brief Start with the overdraw view on (see Engine::drawOverdraw())
+    bool overdraw = false;
+    /// @brief Draw opaque layers front to back with the depth test (false = back to front, for comparison)
+    bool depthOrdering = true;
+};
+
 /**
  * @brief The Engine class.
  * @details The Engine class is responsible for initializing the GLFW window, loading shaders, and rendering the game state.
@@ -23,6 +52,19 @@ class Engine {
         /// @brief The actual GLFW window.
         GLFWwindow* window{};
 
+        /// @brief How to run without a window (disabled by default).
+        HeadlessOptions headless;
+
+        /// @brief The offscreen EGL context used instead of window when headless.
+        /// @details Initialized in initHeadless()
+        unique_ptr<HeadlessContext> headlessContext;
+
+        /// @brief Number of frames presented so far.
+        unsigned int frameCount = 0;
+
+        /// @brief Time the engine was created (the headless clock, since GLFW isn't initialized then).
+        std::chrono::steady_clock::time_point startClock = std::chrono::steady_clock::now();
+
         /// @brief The width and height of the window.
         const unsigned int width = 800, height = 600; // Window dimensions
 
@@ -30,6 +72,9 @@ class Engine {
         /// @details Index this array with GLFW_KEY_{key} to get the state of a key.
         bool keys[1024];
 
+        /// @brief Keyboard state of the previous frame, to catch the frame a key goes down.
+        bool previousKeys[1024];
+
         /// @brief Responsible for loading and storing all the shaders used in the project.
         /// @details Initialized in initShaders()
         unique_ptr<ShaderManager> shaderManager;
@@ -38,6 +83,65 @@ class Engine {
         /// @details Initialized in initShaders()
         unique_ptr<FontRenderer> fontRenderer;
 
+        /// @brief Keeps the laid out and uploaded meshes of the menus and the HUD between frames.
+        /// @details Initialized in initShaders()
+        unique_ptr<TextMeshCache> textMeshCache;
+
+        /// @brief Lines of the text block being submitted (kept around to avoid reallocating every frame).
+        vector<TextLine> textLines;
+
+        /// @brief Draws whole layers of rects (targets1/2/3) with one instanced draw call each.
+        /// @details Initialized in initShaders()
+        unique_ptr<InstancedRenderer> rectRenderer;
+
+        /// @brief Draws layers of circles (same unit quad as rects, cut round by circle.frag) with one instanced draw call.
+        /// @details Initialized in initShaders()
+        unique_ptr<InstancedRenderer> circleRenderer;
+
+        /// @brief Draws the whole mountain range with one instanced draw call (scrolled in scenery.vert).
+        /// @details Initialized in initShaders()
+        unique_ptr<InstancedRenderer> mountainRenderer;
+
+        /// @brief Worker threads the render queue records instances and text layout on (one per extra core).
+        /// @details Initialized in initShaders()
+        unique_ptr<WorkerPool> workers;
+
+        /// @brief Collects the draws of a frame and dispatches them sorted by layer and GL state.
+        /// @details Initialized in initShaders()
+        unique_ptr<RenderQueue> renderQueue;
+
+        /// @brief Times the passes of each frame on the GPU (background, every queue layer, renderText).
+        /// @details Initialized in initShaders()
+        unique_ptr<GpuProfiler> gpuProfiler;
+
+        /// @brief The uniform buffer with the projection, viewport and time every program reads, updated once per frame.
+        /// @details Initialized in initShaders()
+        unique_ptr<FrameUniforms> frameUniforms;
+
+        /// @brief The grass and borders of each level, baked once (index 0 is level 1).
+        /// @details Initialized in initBackgrounds()
+        vector<unique_ptr<StaticLayer>> backgrounds;
+
+        /// @brief Offscreen copy of the frame that survives buffer swaps, so only damaged parts need redrawing.
+        /// @details Initialized in initBackgrounds()
+        unique_ptr<SceneBuffer> scene;
+
+        /// @brief Collects what changed on screen since the last redraw (see trackDamage()).
+        /// @details Initialized in initBackgrounds()
+        unique_ptr<DamageTracker> damage;
+
+        /// @brief What the scene buffer showed after the last redraw, compared in trackDamage().
+        int drawnScreen = -1;
+        bool drawnOverdrawView = false;
+        float drawnMountainScroll = -1.0f;
+        int drawnScore = -1;
+        std::string drawnMode;
+        bool drawnBonusPopup = false;
+
+        /// @brief Screen areas (left, bottom, right, top) that are redrawn as a whole when anything in them changes.
+        /// @details mountainBand covers the whole mountain range (set in initShapes()), hudBand the HUD strings.
+        vec4 mountainBand, hudBand;
+
         unique_ptr<Rect> grass1;
         unique_ptr<Rect> bottomBorder1;
         unique_ptr<Rect> topBorder1;
@@ -53,20 +157,33 @@ class Engine {
         vector<unique_ptr<Rect>> targets1;
         vector<unique_ptr<Rect>> targets2;
         vector<unique_ptr<Rect>> targets3;
+        /// @brief Round targets, moving and drawn with the near targets.
+        vector<unique_ptr<Circle>> circles;
         unique_ptr<Rect> user;
         unique_ptr<Rect> bonusBox;
+        /// @brief Full-screen rect the overdraw view paints its heat colors with.
+        unique_ptr<Rect> overdrawRect;
+        /// @brief Mountain silhouettes behind the targets, drawn as a single instanced layer.
         vector<unique_ptr<Triangle>> mountains;
+        /// @brief How far the mountains have scrolled, in pixels (wraps at the mountain range's width).
+        float mountainScroll = 0.0f;
+        /// @brief Location handle of the scenery shader's "scroll" uniform, resolved once in initShaders().
+        int scrollLocation = -1;
 
         Shader shapeShader;
         Shader textShader;
 
-        double MouseX, MouseY;
+        double MouseX = 0, MouseY = 0;
         bool mousePressedLastFrame = false;
 
+        /// @brief True to show how many times each pixel was drawn instead of the game (toggled with F1).
+        bool overdrawView = false;
+
     public:
         /// @brief Constructor for the Engine class.
-        /// @details Initializes window and shaders.
-        Engine();
+        /// @details Initializes window (or headless context) and shaders.
+        /// @param headless Options for running without a window
+        explicit Engine(HeadlessOptions headless = HeadlessOptions());
 
         /// @brief Destructor for the Engine class.
         ~Engine();
@@ -75,13 +192,43 @@ class Engine {
         /// @return 0 if successful, -1 otherwise.
         unsigned int initWindow(bool debug = false);
 
+        /// @brief Initializes an offscreen EGL context instead of a window.
+        /// @details Also jumps straight to headless.level, since nothing can press a key.
+        /// @return 0 if successful, -1 otherwise.
+        unsigned int initHeadless();
+
+        /// @brief Returns the time in seconds (glfwGetTime(), or a steady clock when headless).
+        double getTime() const;
+
+        /// @brief Returns the GPU profiler, for per-pass GPU milliseconds.
+        const GpuProfiler& getGpuProfiler() const;
+
+        /// @brief Ends the frame: swaps the window's buffers, or flushes (and possibly captures) the offscreen frame.
+        void present();
+
         /// @brief Loads shaders from files and stores them in the shaderManager.
-        /// @details Renderers are initialized here.
+        /// @details Every shader is queued before any is checked, and a loading frame is shown while the driver
+        /// compiles them. Renderers are initialized here, once the shaders are ready.
         void initShaders();
 
+        /// @brief Shows a progress bar while the shaders compile (windowed mode only).
+        /// @param progress The fraction of the shaders that are ready
+        void drawLoadingFrame(float progress);
+
         /// @brief Initializes the shapes to be rendered.
         void initShapes();
 
+        /// @brief Bakes the static background (grass and borders) of every level.
+        /// @details The background rects never move, so they are rendered once here instead of every frame.
+        /// Also creates the scene buffer the frame is redrawn into.
+        void initBackgrounds();
+
+        /// @brief Renders one level's background rects into a new StaticLayer and adds it to backgrounds.
+        /// @param grass The level's background
+        /// @param bottomBorder The level's bottom border
+        /// @param topBorder The level's top border
+        void bakeBackground(const Rect& grass, const Rect& bottomBorder, const Rect& topBorder);
+
         /// @brief Processes input from the user.
         /// @details (e.g. keyboard input, mouse input, etc.)
         void processInput();
@@ -94,17 +241,72 @@ class Engine {
         /// @details Displays/renders objects on the screen.
         void render();
 
+        /// @brief Collects what changed since the last redraw into damage.
+        /// @details A screen change (or the overdraw view) damages the whole screen. On levels, every moving shape
+        /// adds its old and new bounds, the mountain band is damaged when it scrolls, and the HUD band when
+        /// its strings change. The start and over screens never change, so they are only redrawn when entered.
+        void trackDamage();
+
+        /// @brief Redraws the damaged part of the scene buffer.
+        /// @details A small damage is scissored (the clear, the background blit and every draw are clipped to it),
+        /// a large one (see DamageTracker::isFull()) redraws the whole frame.
+        void redraw();
+
+        /// @brief Returns the framebuffer the finished frame is shown in (the window, or the headless FBO).
+        unsigned int getScreenFramebuffer() const;
+
+        /// @brief Returns true if the "BONUS BOX!" popup is shown (while the bonus box is on screen).
+        bool isBonusPopupVisible() const;
+
+        /// @brief Returns true on the frame a key goes down (not while it is held).
+        bool keyPressed(int key) const;
+
+        /// @brief Replaces the frame with a heat map of how many times each pixel was drawn.
+        /// @details The stencil buffer counts the fragments that passed the depth test during the frame
+        /// (see render()); each count is then painted with a full-screen rect that only passes where the
+        /// stencil equals it: black = 0, blue = 1, green = 2, yellow = 3, orange = 4, red = 5 or more.
+        void drawOverdraw();
+
+        /// @brief Restores a level's baked background and queues the shapes and HUD text shared by every level.
+        /// @param background The level's baked background
+        void submitLevel(const StaticLayer& background);
+
+        /// @brief Returns how far the near targets move per frame on the current level (and difficulty).
+        vec2 nearTargetStep() const;
+
+        /// @brief Respawns every target and zeroes the score, shots and clicks for a new round.
+        void resetRound();
+
+        /// @brief Moves the round targets with the near targets, wrapping them around the screen.
+        void updateCircles();
+
+        /// @brief Highlights the round target under the cursor and scores it when clicked.
+        /// @details Uses Circle::contains(), so only clicks inside the radius count.
+        /// @param shot True on the frame the mouse button is released
+        void shootCircles(bool shot);
+
+        /// @brief Returns a line of text (scale 1) centered horizontally on the window
+        TextLine centeredLine(const string& text, float y, vec3 color) const;
+
+        /// @brief Number of round targets spawned with the near targets.
+        const int ROUND_TARGET_COUNT = 4;
+        /// @brief Mountains are placed this far past each side of the screen so they wrap around off screen.
+        const float MOUNTAIN_MARGIN = 80.0f;
+        /// @brief Scroll speed of the mountains, in pixels per second (slower than the targets, for parallax).
+        const float MOUNTAIN_SPEED = 15.0f;
+
         /* deltaTime variables */
         float deltaTime = 0.0f; // Time between current frame and last frame
         float lastFrame = 0.0f; // Time of last frame (used to calculate deltaTime)
 
         /// @brief Returns true if the window should close.
-        /// @details (Wrapper for glfwWindowShouldClose()).
+        /// @details (Wrapper for glfwWindowShouldClose(), or the frame limit when headless).
         /// @return true if the window should close
         /// @return false if the window should not close
         bool shouldClose();
 
         /// Projection matrix used for 2D rendering (orthographic projection).
+        /// Every program reads it from the FrameData block (see frameUniforms), so there is only this one copy.
         /// We don't have to change this matrix since the screen size never changes.
         /// OpenGL uses the projection matrix to map the 3D scene to a 2D viewport.
         /// The projection matrix transforms coordinates in the camera space into normalized device coordinates (view space to clip space).
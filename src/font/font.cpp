@@ -1,77 +1,194 @@
 #include "font.h"
 #include <glad/glad.h>
+#include "../renderer/glState.h"
+#include "../util/utf8.h"
+#include "../util/resources.h"
 
+#include <algorithm>
 #include <iostream>
 
-Font::Font(std::string fontPath, unsigned int fontSize) {
-    FT_Library ft;
-
-    // Initialize FreeType library
-    if (FT_Init_FreeType(&ft)) {
-        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+Font::Font(std::string fontPath, unsigned int fontSize, GlyphMode mode)
+        : fontData(resources::find(fontPath)), fontSize(fontSize), mode(mode) {
+    if (!fontData.data()) {
+        std::cout << "ERROR::FONT: No font resource " << fontPath << std::endl;
+        return;
     }
 
-    // Load font as face
-    FT_Face face;
-    if (FT_New_Face(ft, fontPath.c_str(), 0, &face)) {
-        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+    // Use the baked atlas if it was baked from this font file, size and mode: the one embedded in the executable,
+    // or one an earlier launch baked to disk. Otherwise rasterize it and bake it
+    uint64_t sourceHash = FontAtlas::hashSource(fontData, fontSize, mode);
+    std::string bakedPath = FontAtlas::bakedPath(fontPath, fontSize, mode);
+    std::string_view embedded = resources::find(bakedPath);
+    FontAtlas atlas;
+    if (!atlas.load(reinterpret_cast<const unsigned char*>(embedded.data()), embedded.size(), sourceHash) &&
+        !atlas.load(bakedPath, sourceHash)) {
+        if (!atlas.rasterize(fontData, fontSize, mode))
+            return;
+        atlas.save(bakedPath, sourceHash);
     }
+    glyphScale = atlas.getGlyphScale();
+
+    // The baked atlas is the top half of the grid; the bottom half starts empty and is paged into
+    cellSize = atlas.getCellSize();
+    atlasSize = glm::ivec2(FontAtlas::ATLAS_COLUMNS * cellSize.x, ATLAS_ROWS * cellSize.y);
+    glm::ivec2 bakedSize = atlas.getSize();
+    cellPixels.assign(atlasSize.x * (atlasSize.y - bakedSize.y), 0);
 
-    // Set size to load glyphs as
-    FT_Set_Pixel_Sizes(face, 0, fontSize);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+    glGenTextures(1, &atlasTexture);
+    GLState::bindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasSize.x, atlasSize.y, 0, GL_RED, GL_UNSIGNED_BYTE, nullptr);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, bakedSize.x, bakedSize.y, GL_RED, GL_UNSIGNED_BYTE, atlas.getPixels());
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, bakedSize.y, atlasSize.x, atlasSize.y - bakedSize.y, GL_RED, GL_UNSIGNED_BYTE, cellPixels.data());
 
-    // Attempt to load character glyph
-    if (FT_Load_Char(face, 'X', FT_LOAD_RENDER)) {
-        std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+    // set texture options
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    // The baked ASCII glyphs keep their cells for good (UVs are relative to the whole grid now)
+    cells.assign(FontAtlas::ATLAS_COLUMNS * ATLAS_ROWS, Cell{});
+    pageTable.assign(PAGE_TABLE_SIZE, -1);
+    for (const std::pair<const char, Character> &entry : atlas.getCharacters()) {
+        int c = static_cast<unsigned char>(entry.first);
+        Character character = entry.second;
+        glm::ivec2 origin = cellOrigin(c);
+        character.TextureID = atlasTexture;
+        character.UV = glm::vec4(float(origin.x) / atlasSize.x, float(origin.y) / atlasSize.y,
+                                 float(origin.x + character.Size.x) / atlasSize.x, float(origin.y + character.Size.y) / atlasSize.y);
+        cells[c] = {static_cast<char32_t>(c), character, 0, true};
     }
+}
 
-    glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // disable byte-alignment restriction
+Font::~Font() {
+    GLState::deleteTexture(atlasTexture);
+}
 
-    // Load first 128 characters of ASCII set
-    for (unsigned char c = 0; c < 128; c++) {
-        // load character glyph 
-        if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-            std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+void Font::request(std::string_view text) {
+    for (size_t i = 0; i < text.size();) {
+        char32_t code = utf8::next(text, i);
+        // The baked set is always resident
+        if (code < FontAtlas::GLYPH_COUNT || cells.empty())
             continue;
+        int cell = pageTable[findSlot(code)];
+        if (cell < 0)
+            cell = page(code);
+        if (cell >= 0)
+            cells[cell].lastUsed = frame;
+    }
+}
+
+const Character *Font::find(char32_t code) const {
+    if (cells.empty())
+        return nullptr;
+    if (code < FontAtlas::GLYPH_COUNT)
+        return cells[code].occupied ? &cells[code].character : nullptr;
+    int cell = pageTable[findSlot(code)];
+    return cell >= 0 ? &cells[cell].character : nullptr;
+}
+
+int Font::page(char32_t code) {
+    // Take a free cell, or else the least recently used one that isn't needed this frame
+    int victim = -1;
+    for (int c = FontAtlas::GLYPH_COUNT; c < static_cast<int>(cells.size()); ++c) {
+        if (!cells[c].occupied) {
+            victim = c;
+            break;
+        }
+        if (cells[c].lastUsed != frame && (victim < 0 || cells[c].lastUsed < cells[victim].lastUsed))
+            victim = c;
+    }
+    if (victim < 0 || rasterizerFailed)
+        return -1;
+
+    // FreeType is only started once something outside the baked set shows up
+    if (!rasterizer) {
+        rasterizer = std::make_unique<GlyphRasterizer>(fontData, fontSize, mode);
+        if (!rasterizer->isOpen()) {
+            rasterizerFailed = true;
+            rasterizer.reset();
+            return -1;
         }
+    }
+    Character character;
+    if (!rasterizer->render(code, character, glyphBitmap))
+        return -1;
+
+    if (cells[victim].occupied) {
+        unpage(cells[victim].code);
+        generation++;
+    }
+
+    // Upload the whole cell, so nothing of the evicted glyph is left around the new one.
+    // The cell size comes from the ASCII set, so a larger glyph is clipped to it.
+    glm::ivec2 glyphSize = glm::clamp(character.Size, glm::ivec2(0), cellSize - glm::ivec2(FontAtlas::ATLAS_PADDING));
+    cellPixels.assign(cellSize.x * cellSize.y, 0);
+    for (int row = 0; row < glyphSize.y; row++)
+        std::copy(glyphBitmap.begin() + row * character.Size.x, glyphBitmap.begin() + row * character.Size.x + glyphSize.x,
+                  cellPixels.begin() + row * cellSize.x);
+    glm::ivec2 origin = cellOrigin(victim);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    GLState::bindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, origin.x, origin.y, cellSize.x, cellSize.y, GL_RED, GL_UNSIGNED_BYTE, cellPixels.data());
+
+    character.TextureID = atlasTexture;
+    character.Size = glyphSize;
+    character.UV = glm::vec4(float(origin.x) / atlasSize.x, float(origin.y) / atlasSize.y,
+                             float(origin.x + glyphSize.x) / atlasSize.x, float(origin.y + glyphSize.y) / atlasSize.y);
+    cells[victim] = {code, character, frame, true};
+    pageTable[findSlot(code)] = static_cast<int16_t>(victim);
+    return victim;
+}
+
+size_t Font::homeSlot(char32_t code) {
+    // Multiplying by an odd constant permutes the low bits, so nearby code points (one script) never collide
+    return (static_cast<uint32_t>(code) * 2654435761u) & (PAGE_TABLE_SIZE - 1);
+}
+
+size_t Font::findSlot(char32_t code) const {
+    // There are twice as many slots as paged cells, so the probe always ends at an empty slot
+    size_t slot = homeSlot(code);
+    while (pageTable[slot] >= 0 && cells[pageTable[slot]].code != code)
+        slot = (slot + 1) & (PAGE_TABLE_SIZE - 1);
+    return slot;
+}
+
+void Font::unpage(char32_t code) {
+    size_t hole = findSlot(code);
+    if (pageTable[hole] < 0)
+        return;
+    pageTable[hole] = -1;
 
-        // generate texture
-        unsigned int texture;
-        glGenTextures(1, &texture);
-        glBindTexture(GL_TEXTURE_2D, texture);
-        glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            GL_RED,
-            face->glyph->bitmap.width,
-            face->glyph->bitmap.rows,
-            0,
-            GL_RED,
-            GL_UNSIGNED_BYTE,
-            face->glyph->bitmap.buffer
-        );
-
-        // set texture options
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // now store character for later use
-        Character character = {
-            texture,
-            glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows),
-            glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
-            static_cast<unsigned int>(face->glyph->advance.x)
-        };
-        Characters.insert(std::pair<char, Character>(c, character));
+    // Backward shift deletion: pull later entries of the probe run into the hole when their home allows it,
+    // so lookups never need tombstones
+    const size_t mask = PAGE_TABLE_SIZE - 1;
+    for (size_t slot = (hole + 1) & mask; pageTable[slot] >= 0; slot = (slot + 1) & mask) {
+        size_t home = homeSlot(cells[pageTable[slot]].code);
+        if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+            pageTable[hole] = pageTable[slot];
+            pageTable[slot] = -1;
+            hole = slot;
+        }
     }
-    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+glm::ivec2 Font::cellOrigin(int cell) const {
+    return glm::ivec2((cell % FontAtlas::ATLAS_COLUMNS) * cellSize.x, (cell / FontAtlas::ATLAS_COLUMNS) * cellSize.y);
+}
+
+void Font::endFrame() {
+    frame++;
+}
+
+unsigned int Font::getGeneration() const {
+    return generation;
+}
 
-    FT_Done_Face(face);
-    FT_Done_FreeType(ft);
+unsigned int Font::getAtlasTexture() const {
+    return atlasTexture;
 }
 
-std::map<char, Character> Font::getCharacters() const {
-    return Characters;
+float Font::getGlyphScale() const {
+    return glyphScale;
 }
@@ -1,59 +1,188 @@
 #ifndef GRAPHICS_FONT_H
 #define GRAPHICS_FONT_H
 
-#include <map>
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <string_view>
+#include <vector>
 
-
-#include "glm/glm.hpp"
-
-#include "ft2build.h"
-#include FT_FREETYPE_H//"freetype/freetype.h"
-
-/**
- * @brief A single character
- * @details This struct is used to store information about a single character
- * 
- * @param TextureID ID handle of the glyph texture
- * @param Size Size of glyph
- * @param Bearing Offset from baseline to left/top of glyph
- * @param Advance Offset to advance to next glyph
- */
-struct Character {
-    unsigned int TextureID;
-    glm::ivec2   Size;
-    glm::ivec2   Bearing;
-    unsigned int Advance;
-};
+#include "fontAtlas.h"
 
 /**
  * @brief A font
- * @details This class is used to store information about a font
+ * @details This class is used to store information about a font.
+ * Every glyph is packed into one atlas texture (a grid of equal cells, one per glyph), so a whole string
+ * can be drawn with a single texture bound.
+ * The font file and the ASCII set baked by the bakeFonts target (see FontAtlas::bakedPath()) are embedded in the
+ * executable (see resources::find()), so the set is ready with one texture upload. FreeType only runs when the
+ * baked atlas is missing or stale (e.g. the font was swapped through the resource override), and the result is then
+ * baked to disk for the next launch.
+ *
+ * The atlas has a fixed number of cells, so memory stays bounded whatever characters are drawn: the baked ASCII
+ * cells are always resident, and every other character is rasterized the first time it is requested and paged into
+ * the remaining cells, evicting the least recently used glyph when they are full. Glyphs requested in the current
+ * frame are never evicted, so everything submitted in a frame can still be drawn at the end of it.
  */
 class Font {
     public:
         /**
          * @brief Construct a new Font object
-         * 
-         * @param fontPath The path to the font file
-         * @param fontSize The size of the font
+         *
+         * @param fontPath The font resource (its path inside res/, e.g. "fonts/MxPlus_IBM_BIOS.ttf")
+         * @param fontSize The size of the font (the size text is laid out at with scale 1)
+         * @param mode Whether the atlas stores coverage bitmaps or signed distance fields
+         */
+        Font(std::string fontPath, unsigned int fontSize, GlyphMode mode = GlyphMode::Bitmap);
+
+        /**
+         * @brief Destroy the Font object and delete its atlas texture
+         */
+        ~Font();
+
+        Font(const Font&) = delete;
+        Font& operator=(const Font&) = delete;
+
+        /**
+         * @brief Makes every character of a UTF-8 string resident in the atlas and marks it used this frame
+         * @details Uploads to the atlas, so it must be called on the GL thread, before the string is laid out.
+         */
+        void request(std::string_view text);
+
+        /**
+         * @brief Finds a resident glyph
+         * @details Never changes the font, so any number of threads can lay out text at once (between requests).
+         *
+         * @param code The Unicode code point
+         * @return The glyph, or nullptr if it isn't resident (see request())
+         */
+        const Character* find(char32_t code) const;
+
+        /**
+         * @brief Starts a new frame for the least recently used bookkeeping
          */
-        Font(std::string fontPath, unsigned int fontSize);
+        void endFrame();
 
-        
         /**
-         * @brief Get the characters
-         * 
-         * @return a map of characters
+         * @brief Get the number of glyphs evicted so far
+         * @details Text laid out before the generation changed may point at a cell that now holds another glyph,
+         * so whatever keeps laid out text around (see TextMeshCache) compares generations.
          */
-        std::map<char, Character> getCharacters() const;
+        unsigned int getGeneration() const;
+
+        /**
+         * @brief Get the atlas texture every glyph is in
+         */
+        unsigned int getAtlasTexture() const;
+
+        /**
+         * @brief Get the factor from glyph metrics to the font size
+         * @details 1 for bitmaps. SDF glyphs are rasterized at a fixed small size (see GlyphRasterizer), so their
+         * sizes, bearings and advances are multiplied by fontSize / that size when laid out.
+         */
+        float getGlyphScale() const;
 
     private:
         /**
-         * @brief A set of character structs mapped to their ASCII character representations
+         * @brief A cell of the atlas and the glyph in it
+         */
+        struct Cell {
+            char32_t code;
+            Character character;
+            /**
+             * @brief Frame the glyph was last requested in
+             */
+            unsigned int lastUsed;
+            bool occupied;
+        };
+
+        /**
+         * @brief Every cell of the atlas; cell c < 128 holds ASCII character c
+         */
+        std::vector<Cell> cells;
+
+        /**
+         * @brief Open addressing table (linear probing) from the code point of every paged glyph to its cell (-1 = empty)
+         */
+        std::vector<int16_t> pageTable;
+
+        /**
+         * @brief Size of a cell in pixels (the largest ASCII glyph plus padding)
+         */
+        glm::ivec2 cellSize = glm::ivec2(0, 0);
+
+        /**
+         * @brief Size of the atlas texture in pixels
          */
-        std::map<char, Character> Characters;
+        glm::ivec2 atlasSize = glm::ivec2(0, 0);
 
+        /**
+         * @brief ID handle of the atlas texture
+         */
+        unsigned int atlasTexture = 0;
+
+        /**
+         * @brief See getGlyphScale()
+         */
+        float glyphScale = 1.0f;
+
+        /**
+         * @brief Number of endFrame() calls so far
+         */
+        unsigned int frame = 0;
+
+        /**
+         * @brief See getGeneration()
+         */
+        unsigned int generation = 0;
+
+        /* Opened the first time a character outside the baked set is requested */
+        std::string_view fontData;
+        unsigned int fontSize;
+        GlyphMode mode;
+        std::unique_ptr<GlyphRasterizer> rasterizer;
+        bool rasterizerFailed = false;
+
+        /**
+         * @brief Scratch space a paged glyph is rendered into, and the cell it is copied into for the upload
+         */
+        std::vector<unsigned char> glyphBitmap, cellPixels;
+
+        /**
+         * @brief Rows of the atlas grid (the first 8 hold the baked ASCII set, the rest are paged)
+         */
+        static const int ATLAS_ROWS = 16;
+
+        /**
+         * @brief Slots of pageTable (twice the paged cells, so probes stay short)
+         */
+        static const int PAGE_TABLE_SIZE = 256;
+
+        /**
+         * @brief Rasterizes a glyph into a free or least recently used cell
+         * @return The glyph's cell, or -1 if every paged cell is in use this frame (or it couldn't be rasterized)
+         */
+        int page(char32_t code);
+
+        /**
+         * @brief Returns the slot of pageTable a code point's probe sequence starts at
+         */
+        static size_t homeSlot(char32_t code);
+
+        /**
+         * @brief Returns the slot of pageTable that holds code, or the empty slot where it would go
+         */
+        size_t findSlot(char32_t code) const;
+
+        /**
+         * @brief Removes a code point from pageTable, moving later entries of its probe sequence back
+         */
+        void unpage(char32_t code);
+
+        /**
+         * @brief Returns the pixel origin of a cell in the atlas
+         */
+        glm::ivec2 cellOrigin(int cell) const;
 };
 
 #endif //GRAPHICS_FONT_H
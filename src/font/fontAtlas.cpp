@@ -0,0 +1,321 @@
+#include "fontAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include FT_MODULE_H
+
+#include "../util/hash.h"
+
+namespace {
+    /**
+     * @brief Start of a baked atlas file
+     */
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceHash;
+        int32_t width, height;
+        uint32_t glyphCount;
+        float glyphScale;
+    };
+
+    /**
+     * @brief One character of a baked atlas file
+     */
+    struct FileGlyph {
+        int32_t code;
+        int32_t size[2];
+        int32_t bearing[2];
+        uint32_t advance;
+        float uv[4];
+    };
+
+    const char FILE_MAGIC[4] = {'F', 'N', 'T', 'A'};
+}
+
+FontAtlas::~FontAtlas() {
+    unmap();
+}
+
+void FontAtlas::unmap() {
+#ifndef _WIN32
+    if (mapping)
+        munmap(mapping, mappingSize);
+#endif
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+GlyphRasterizer::GlyphRasterizer(std::string_view fontData, unsigned int fontSize, GlyphMode mode) : mode(mode) {
+    // Initialize FreeType library
+    if (FT_Init_FreeType(&library)) {
+        std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+        library = nullptr;
+        return;
+    }
+
+    // A wider spread than the default keeps the edge smooth when the small SDF is magnified
+    if (mode == GlyphMode::SDF) {
+        FT_Int spread = SDF_SPREAD;
+        FT_Property_Set(library, "sdf", "spread", &spread);
+        FT_Property_Set(library, "bsdf", "spread", &spread);
+    }
+
+    // Load font as face
+    if (FT_New_Memory_Face(library, reinterpret_cast<const FT_Byte*>(fontData.data()), static_cast<FT_Long>(fontData.size()), 0, &face)) {
+        std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+        face = nullptr;
+        return;
+    }
+
+    // Set size to load glyphs as (SDF glyphs are rasterized small and scaled up when laid out)
+    unsigned int pixelSize = mode == GlyphMode::SDF ? SDF_PIXEL_SIZE : fontSize;
+    glyphScale = float(fontSize) / pixelSize;
+    FT_Set_Pixel_Sizes(face, 0, pixelSize);
+}
+
+GlyphRasterizer::~GlyphRasterizer() {
+    if (face)
+        FT_Done_Face(face);
+    if (library)
+        FT_Done_FreeType(library);
+}
+
+bool GlyphRasterizer::isOpen() const {
+    return face != nullptr;
+}
+
+bool GlyphRasterizer::render(char32_t code, Character &character, std::vector<unsigned char> &bitmap) {
+    // load character glyph from its outline; the font's embedded strikes are 1-bit, which neither mode can use
+    if (FT_Load_Char(face, code, mode == GlyphMode::SDF ? FT_LOAD_NO_BITMAP : FT_LOAD_RENDER | FT_LOAD_NO_BITMAP)) {
+        std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+        return false;
+    }
+    // Glyphs without an outline (e.g. space) keep their empty bitmap and only advance
+    if (mode == GlyphMode::SDF && face->glyph->outline.n_points > 0 &&
+        FT_Render_Glyph(face->glyph, FT_RENDER_MODE_SDF)) {
+        std::cout << "ERROR::FREETYTPE: Failed to render SDF Glyph" << std::endl;
+        return false;
+    }
+
+    // An unrendered slot (no outline) still holds the fields of the previous bitmap, so it counts as empty
+    FT_Bitmap &glyphBitmap = face->glyph->bitmap;
+    bool rendered = face->glyph->format == FT_GLYPH_FORMAT_BITMAP;
+    glm::ivec2 glyphSize = rendered ? glm::ivec2(glyphBitmap.width, glyphBitmap.rows) : glm::ivec2(0, 0);
+    bitmap.resize(glyphSize.x * glyphSize.y);
+    for (int row = 0; row < glyphSize.y; row++)
+        std::copy(glyphBitmap.buffer + row * glyphBitmap.pitch, glyphBitmap.buffer + row * glyphBitmap.pitch + glyphSize.x,
+                  bitmap.begin() + row * glyphSize.x);
+    character = {
+        0,
+        glyphSize,
+        glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top),
+        static_cast<unsigned int>(face->glyph->advance.x),
+        glm::vec4(0.0f)
+    };
+    return true;
+}
+
+float GlyphRasterizer::getGlyphScale() const {
+    return glyphScale;
+}
+
+bool FontAtlas::rasterize(std::string_view fontData, unsigned int fontSize, GlyphMode mode) {
+    GlyphRasterizer rasterizer(fontData, fontSize, mode);
+    if (!rasterizer.isOpen())
+        return false;
+    glyphScale = rasterizer.getGlyphScale();
+
+    // Render the first 128 characters of the ASCII set, keeping the bitmaps until we know the largest one
+    std::vector<std::vector<unsigned char>> bitmaps(GLYPH_COUNT);
+    glm::ivec2 cell(0, 0);
+    characters.clear();
+    for (int c = 0; c < GLYPH_COUNT; c++) {
+        Character character;
+        if (!rasterizer.render(c, character, bitmaps[c]))
+            continue;
+        cell = glm::max(cell, character.Size);
+        characters.insert(std::pair<char, Character>(static_cast<char>(c), character));
+    }
+
+    // Copy every glyph into its own cell of the atlas
+    cell += glm::ivec2(ATLAS_PADDING);
+    size = glm::ivec2(ATLAS_COLUMNS * cell.x, (GLYPH_COUNT / ATLAS_COLUMNS) * cell.y);
+    unmap();
+    storage.assign(size.x * size.y, 0);
+    for (std::pair<const char, Character> &entry : characters) {
+        Character &ch = entry.second;
+        unsigned char c = static_cast<unsigned char>(entry.first);
+        glm::ivec2 origin((c % ATLAS_COLUMNS) * cell.x, (c / ATLAS_COLUMNS) * cell.y);
+        for (int row = 0; row < ch.Size.y; row++)
+            std::copy(bitmaps[c].begin() + row * ch.Size.x, bitmaps[c].begin() + (row + 1) * ch.Size.x,
+                      storage.begin() + (origin.y + row) * size.x + origin.x);
+        ch.UV = glm::vec4(float(origin.x) / size.x, float(origin.y) / size.y,
+                          float(origin.x + ch.Size.x) / size.x, float(origin.y + ch.Size.y) / size.y);
+    }
+    pixels = storage.data();
+    return true;
+}
+
+bool FontAtlas::load(const std::string &path, uint64_t sourceHash) {
+    unmap();
+    storage.clear();
+    pixels = nullptr;
+
+    // Map the whole file; the pixels are then read straight from the page cache by the texture upload
+    const unsigned char *data = nullptr;
+    size_t dataSize = 0;
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            mapping = mapped;
+            mappingSize = info.st_size;
+            data = static_cast<const unsigned char*>(mapped);
+            dataSize = mappingSize;
+        }
+    }
+    close(fd);
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    storage.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = storage.data();
+    dataSize = storage.size();
+#endif
+    if (!data || !read(data, dataSize, sourceHash)) {
+        unmap();
+        storage.clear();
+        return false;
+    }
+    return true;
+}
+
+bool FontAtlas::load(const unsigned char *data, size_t dataSize, uint64_t sourceHash) {
+    unmap();
+    storage.clear();
+    pixels = nullptr;
+    return data && read(data, dataSize, sourceHash);
+}
+
+bool FontAtlas::read(const unsigned char *data, size_t dataSize, uint64_t sourceHash) {
+    // Reject anything that isn't a complete file of this version, baked from this font
+    FileHeader header;
+    bool valid = dataSize >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, data, sizeof(header));
+        valid = std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 && header.version == FILE_VERSION &&
+                header.sourceHash == sourceHash && header.width > 0 && header.height > 0 && header.glyphCount <= GLYPH_COUNT &&
+                dataSize == sizeof(header) + header.glyphCount * sizeof(FileGlyph) + size_t(header.width) * header.height;
+    }
+    if (!valid)
+        return false;
+
+    characters.clear();
+    const unsigned char *glyphData = data + sizeof(header);
+    for (uint32_t i = 0; i < header.glyphCount; ++i) {
+        FileGlyph glyph;
+        std::memcpy(&glyph, glyphData + i * sizeof(FileGlyph), sizeof(glyph));
+        Character character = {
+            0,
+            glm::ivec2(glyph.size[0], glyph.size[1]),
+            glm::ivec2(glyph.bearing[0], glyph.bearing[1]),
+            glyph.advance,
+            glm::vec4(glyph.uv[0], glyph.uv[1], glyph.uv[2], glyph.uv[3])
+        };
+        characters.insert(std::pair<char, Character>(static_cast<char>(glyph.code), character));
+    }
+    size = glm::ivec2(header.width, header.height);
+    glyphScale = header.glyphScale;
+    pixels = glyphData + header.glyphCount * sizeof(FileGlyph);
+    return true;
+}
+
+bool FontAtlas::save(const std::string &path, uint64_t sourceHash) const {
+    if (!pixels)
+        return false;
+
+    std::error_code error;
+    std::filesystem::path parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty())
+        std::filesystem::create_directories(parent, error);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::FONTATLAS: Could not write " << path << std::endl;
+        return false;
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.sourceHash = sourceHash;
+    header.width = size.x;
+    header.height = size.y;
+    header.glyphCount = static_cast<uint32_t>(characters.size());
+    header.glyphScale = glyphScale;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    for (const std::pair<const char, Character> &entry : characters) {
+        const Character &ch = entry.second;
+        FileGlyph glyph = {
+            static_cast<unsigned char>(entry.first),
+            {ch.Size.x, ch.Size.y},
+            {ch.Bearing.x, ch.Bearing.y},
+            ch.Advance,
+            {ch.UV.x, ch.UV.y, ch.UV.z, ch.UV.w}
+        };
+        file.write(reinterpret_cast<const char*>(&glyph), sizeof(glyph));
+    }
+
+    file.write(reinterpret_cast<const char*>(pixels), size_t(size.x) * size.y);
+    return bool(file);
+}
+
+uint64_t FontAtlas::hashSource(std::string_view fontData, unsigned int fontSize, GlyphMode mode) {
+    uint64_t sourceHash = hash::fnv1a(hash::FNV_OFFSET, fontData.data(), fontData.size());
+    uint32_t settings[3] = {fontSize, static_cast<uint32_t>(mode), FILE_VERSION};
+    return hash::fnv1a(sourceHash, settings, sizeof(settings));
+}
+
+std::string FontAtlas::bakedPath(const std::string &fontPath, unsigned int fontSize, GlyphMode mode) {
+    std::string name = std::filesystem::path(fontPath).stem().string();
+    return "fonts/" + name + "." + std::to_string(fontSize) + (mode == GlyphMode::SDF ? ".sdf" : ".bitmap") + ".atlas";
+}
+
+const std::map<char, Character> &FontAtlas::getCharacters() const {
+    return characters;
+}
+
+glm::ivec2 FontAtlas::getSize() const {
+    return size;
+}
+
+glm::ivec2 FontAtlas::getCellSize() const {
+    return size / glm::ivec2(ATLAS_COLUMNS, GLYPH_COUNT / ATLAS_COLUMNS);
+}
+
+const unsigned char *FontAtlas::getPixels() const {
+    return pixels;
+}
+
+float FontAtlas::getGlyphScale() const {
+    return glyphScale;
+}
@@ -0,0 +1,253 @@
+#ifndef GRAPHICS_FONTATLAS_H
+#define GRAPHICS_FONTATLAS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "ft2build.h"
+#include FT_FREETYPE_H
+
+/**
+ * @brief A single character
+ * @details This struct is used to store information about a single character
+ *
+ * @param TextureID ID handle of the atlas texture the glyph is in (the same for every glyph of a font)
+ * @param Size Size of glyph
+ * @param Bearing Offset from baseline to left/top of glyph
+ * @param Advance Offset to advance to next glyph
+ * @param UV Rectangle of the glyph in the atlas (u0, v0 = top left, u1, v1 = bottom right)
+ */
+struct Character {
+    unsigned int TextureID;
+    glm::ivec2   Size;
+    glm::ivec2   Bearing;
+    unsigned int Advance;
+    glm::vec4    UV;
+};
+
+/**
+ * @brief What the atlas of a font stores for each glyph
+ *
+ * @param Bitmap Coverage rasterized at the font size (blurs when scaled)
+ * @param SDF Signed distance to the outline, rasterized once at a small size (stays crisp at any scale, see textSdf.frag)
+ */
+enum class GlyphMode { Bitmap, SDF };
+
+/**
+ * @brief Renders single glyphs of a font with FreeType
+ * @details Used by FontAtlas to rasterize the baked range, and by Font to page in other characters on demand.
+ */
+class GlyphRasterizer {
+    public:
+        /**
+         * @brief Opens a font (check isOpen())
+         *
+         * @param fontData The contents of the font file (read in place, so it must outlive the rasterizer)
+         * @param fontSize The size of the font
+         * @param mode Whether to render coverage bitmaps or signed distance fields
+         */
+        GlyphRasterizer(std::string_view fontData, unsigned int fontSize, GlyphMode mode);
+
+        /**
+         * @brief Destroy the Glyph Rasterizer object and close the font
+         */
+        ~GlyphRasterizer();
+
+        GlyphRasterizer(const GlyphRasterizer&) = delete;
+        GlyphRasterizer& operator=(const GlyphRasterizer&) = delete;
+
+        /**
+         * @brief Returns true if the font could be opened
+         */
+        bool isOpen() const;
+
+        /**
+         * @brief Renders one glyph (characters the font doesn't have render as its missing glyph box)
+         *
+         * @param code The Unicode code point
+         * @param character Gets the size, bearing and advance of the glyph (TextureID and UV are left 0)
+         * @param bitmap Gets the Size.x * Size.y pixels of the glyph, rows top to bottom
+         * @return false if FreeType failed to render the glyph
+         */
+        bool render(char32_t code, Character& character, std::vector<unsigned char>& bitmap);
+
+        /**
+         * @brief Get the factor from glyph metrics to the font size (see Font::getGlyphScale())
+         */
+        float getGlyphScale() const;
+
+    private:
+        FT_Library library = nullptr;
+        FT_Face face = nullptr;
+        GlyphMode mode;
+        float glyphScale = 1.0f;
+
+        /**
+         * @brief Pixel size SDF glyphs are rasterized at, whatever size they are drawn at
+         */
+        static const unsigned int SDF_PIXEL_SIZE = 16;
+
+        /**
+         * @brief Distance (in pixels of SDF_PIXEL_SIZE) the SDF ramps over on each side of the outline
+         */
+        static const int SDF_SPREAD = 4;
+};
+
+/**
+ * @brief The glyphs of a font packed into one image, with their metrics
+ * @details Touches no GL, so the font baker (tools/fontBaker.cpp) shares it with Font.
+ * An atlas is either rasterized with FreeType, or loaded from a baked file: one embedded in the executable
+ * (see resources::find()), or one on disk, which is mapped into memory so the pixels go straight from the file
+ * to the texture upload.
+ *
+ * A baked file is a header, the characters, then the pixels (one byte each, rows top to bottom).
+ * The header holds the hash of the font file, size and mode it was baked from (see hashSource()),
+ * so a file baked from another version of the font is rejected as stale.
+ */
+class FontAtlas {
+    public:
+        /**
+         * @brief Number of characters baked into the atlas (the ASCII set)
+         */
+        static const int GLYPH_COUNT = 128;
+
+        /**
+         * @brief Columns of the atlas grid (128 glyphs make 8 rows)
+         */
+        static const int ATLAS_COLUMNS = 16;
+
+        /**
+         * @brief Empty pixels between cells, so linear filtering never picks up a neighbouring glyph
+         */
+        static const int ATLAS_PADDING = 1;
+
+        FontAtlas() = default;
+
+        /**
+         * @brief Destroy the Font Atlas object and unmap its file, if it was loaded
+         */
+        ~FontAtlas();
+
+        FontAtlas(const FontAtlas&) = delete;
+        FontAtlas& operator=(const FontAtlas&) = delete;
+
+        /**
+         * @brief Rasterizes the first 128 characters of a font with FreeType
+         * @details Every glyph gets its own cell of a 16 column grid (cell = largest glyph + padding).
+         *
+         * @param fontData The contents of the font file
+         * @param fontSize The size of the font
+         * @param mode Whether to store coverage bitmaps or signed distance fields
+         * @return true if the font could be loaded
+         */
+        bool rasterize(std::string_view fontData, unsigned int fontSize, GlyphMode mode);
+
+        /**
+         * @brief Maps a baked atlas file into memory
+         *
+         * @param path The baked file
+         * @param sourceHash The hash the file must have been baked from (see hashSource())
+         * @return false if the file is missing, malformed or stale
+         */
+        bool load(const std::string& path, uint64_t sourceHash);
+
+        /**
+         * @brief Reads a baked atlas file that is already in memory (e.g. embedded in the executable)
+         *
+         * @param data The contents of the file (the pixels are read in place, so it must outlive the atlas)
+         * @param dataSize Size of the file in bytes
+         * @param sourceHash The hash the file must have been baked from (see hashSource())
+         * @return false if the file is malformed or stale
+         */
+        bool load(const unsigned char* data, size_t dataSize, uint64_t sourceHash);
+
+        /**
+         * @brief Writes the atlas to a baked file (creating its directory if needed)
+         *
+         * @param path The baked file
+         * @param sourceHash The hash of what the atlas was rasterized from (see hashSource())
+         * @return true if the file was written
+         */
+        bool save(const std::string& path, uint64_t sourceHash) const;
+
+        /**
+         * @brief Hashes (FNV-1a) the contents of a font file together with the size, mode and file format version
+         */
+        static uint64_t hashSource(std::string_view fontData, unsigned int fontSize, GlyphMode mode);
+
+        /**
+         * @brief Returns where the baked atlas of a font is looked for: fonts/<name>.<size>.<bitmap|sdf>.atlas
+         * @details Relative to the working directory, i.e. the build directory, where the bakeFonts target writes it.
+         * It is also the name the atlas is embedded in the executable under.
+         */
+        static std::string bakedPath(const std::string& fontPath, unsigned int fontSize, GlyphMode mode);
+
+        /**
+         * @brief Get the characters (TextureID is 0, the atlas isn't uploaded yet)
+         */
+        const std::map<char, Character>& getCharacters() const;
+
+        /**
+         * @brief Get the width and height of the atlas in pixels
+         */
+        glm::ivec2 getSize() const;
+
+        /**
+         * @brief Get the size of one cell of the grid (the largest glyph plus padding)
+         */
+        glm::ivec2 getCellSize() const;
+
+        /**
+         * @brief Get the pixels of the atlas (one byte each, rows top to bottom)
+         */
+        const unsigned char* getPixels() const;
+
+        /**
+         * @brief Get the factor from glyph metrics to the font size (see Font::getGlyphScale())
+         */
+        float getGlyphScale() const;
+
+    private:
+        std::map<char, Character> characters;
+        glm::ivec2 size = glm::ivec2(0, 0);
+        float glyphScale = 1.0f;
+
+        /**
+         * @brief Pixels of a rasterized atlas, or the whole baked file where it can't be mapped (Windows)
+         */
+        std::vector<unsigned char> storage;
+
+        /**
+         * @brief Points into storage or into the mapped file
+         */
+        const unsigned char* pixels = nullptr;
+
+        /**
+         * @brief The mapped baked file, if the atlas was loaded
+         */
+        void* mapping = nullptr;
+        size_t mappingSize = 0;
+
+        /**
+         * @brief Unmaps the baked file, if one is mapped
+         */
+        void unmap();
+
+        /**
+         * @brief Checks a baked file and reads its characters, pointing pixels into it (see load())
+         */
+        bool read(const unsigned char* data, size_t dataSize, uint64_t sourceHash);
+
+        /**
+         * @brief Version of the baked file layout, bumped whenever it (or the rasterization) changes
+         */
+        static const uint32_t FILE_VERSION = 1;
+};
+
+#endif //GRAPHICS_FONTATLAS_H
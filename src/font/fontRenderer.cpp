@@ -3,72 +3,157 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
-FontRenderer::FontRenderer(Shader& shader, std::string fontPath, int fontSize) {
+#include "../renderer/glState.h"
+#include "../util/utf8.h"
+
+#include <algorithm>
+#include <cstddef>
+
+FontRenderer::FontRenderer(Shader& shader, std::string fontPath, int fontSize, GlyphMode mode) {
     this->shader = shader;
     this->initRenderData();
-    Font myFont(fontPath, fontSize);
-    this->font = myFont.getCharacters();
+    this->font = std::make_unique<Font>(fontPath, fontSize, mode);
 }
 
 FontRenderer::~FontRenderer() {
-    glDeleteVertexArrays(1, &this->VAO);
-    glDeleteBuffers(1, &this->VBO);
+    GLState::deleteVertexArray(this->VAO);
 }
 
 void FontRenderer::initRenderData() {
+    // Room for REGION_GLYPHS glyphs per region; every glyph quad is appended, never overwritten in place
+    this->vertexStream = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, GLYPH_BYTES * REGION_GLYPHS);
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &this->VBO);
-    glBindVertexArray(this->VAO);
-    glBindBuffer(GL_ARRAY_BUFFER, this->VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * 6 * 4, NULL, GL_DYNAMIC_DRAW);
+    GLState::bindVertexArray(this->VAO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, this->vertexStream->getID());
+    setVertexAttributes();
+}
+
+void FontRenderer::setVertexAttributes() {
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), 0);
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(GlyphVertex), (void*)offsetof(GlyphVertex, x));
+    // The packed color stays an integer in the shader (note the I in glVertexAttribIPointer)
+    glEnableVertexAttribArray(1);
+    glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(GlyphVertex), (void*)offsetof(GlyphVertex, color));
 }
 
-void FontRenderer::renderText(std::string text, float x, float y, float scale, glm::vec3 color) {
-    // activate corresponding render state
+void FontRenderer::requestGlyphs(std::string_view text) {
+    font->request(text);
+}
 
-    this->shader.use();
-    glUniformMatrix4fv(glGetUniformLocation(this->shader.ID, "projection"), 1, false, glm::value_ptr(projection));
-    glUniform3f(glGetUniformLocation(this->shader.ID, "textColor"), color.x, color.y, color.z);
+unsigned int FontRenderer::getAtlasGeneration() const {
+    return font->getGeneration();
+}
+
+void FontRenderer::endFrame() {
+    font->endFrame();
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindVertexArray(this->VAO);
+const Shader& FontRenderer::getShader() const {
+    return shader;
+}
+
+GLuint FontRenderer::getVAO() const {
+    return VAO;
+}
+
+GLuint FontRenderer::getAtlasTexture() const {
+    return font->getAtlasTexture();
+}
+
+void FontRenderer::setProfiler(GpuProfiler *profiler) {
+    this->profiler = profiler;
+}
+
+void FontRenderer::renderText(std::string_view text, float x, float y, float scale, glm::vec3 color) {
+    requestGlyphs(text);
+    glyphVertices.resize(text.size() * VERTICES_PER_GLYPH);
+    size_t glyphCount = layoutText(text, x, y, scale, color, glyphVertices.data());
+    drawGlyphs(glyphVertices.data(), glyphCount);
+}
 
-    // iterate through all characters
-    std::string::const_iterator c;
-    for (c = text.begin(); c != text.end(); c++) {
-        Character ch = font[*c];
+size_t FontRenderer::layoutText(std::string_view text, float x, float y, float scale, glm::vec3 color,
+                                GlyphVertex *vertices) const {
+    unsigned int packedColor = color::pack(glm::vec4(color, 1.0f));
+    // SDF glyphs are stored smaller than the font size
+    scale *= font->getGlyphScale();
 
-        float xpos = x + ch.Bearing.x * scale;
+    // iterate through all characters (pen is the cursor position, starting at x)
+    size_t glyphCount = 0;
+    float pen = x;
+    for (size_t i = 0; i < text.size();) {
+        // find() never pages glyphs in, so it is safe to call from several threads
+        const Character *glyph = font->find(utf8::next(text, i));
+        if (!glyph)
+            continue;
+        const Character &ch = *glyph;
+
+        float xpos = pen + ch.Bearing.x * scale;
         float ypos = y - (ch.Size.y - ch.Bearing.y) * scale;
 
         float w = ch.Size.x * scale;
         float h = ch.Size.y * scale;
-        // update VBO for each character
-        float vertices[6][4] = {
-            { xpos,     ypos + h,   0.0f, 0.0f },            
-            { xpos,     ypos,       0.0f, 1.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-
-            { xpos,     ypos + h,   0.0f, 0.0f },
-            { xpos + w, ypos,       1.0f, 1.0f },
-            { xpos + w, ypos + h,   1.0f, 0.0f }           
+        // UV.xy is the top left of the glyph in the atlas, UV.zw the bottom right
+        const glm::vec4 &uv = ch.UV;
+        GlyphVertex quad[VERTICES_PER_GLYPH] = {
+            { xpos,     ypos + h,   uv.x, uv.y, packedColor },
+            { xpos,     ypos,       uv.x, uv.w, packedColor },
+            { xpos + w, ypos,       uv.z, uv.w, packedColor },
+
+            { xpos,     ypos + h,   uv.x, uv.y, packedColor },
+            { xpos + w, ypos,       uv.z, uv.w, packedColor },
+            { xpos + w, ypos + h,   uv.z, uv.y, packedColor }
         };
-        // render glyph texture over quad
-        glBindTexture(GL_TEXTURE_2D, ch.TextureID);
-        // update content of VBO memory
-        glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices); 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        // render quad
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        std::copy(quad, quad + VERTICES_PER_GLYPH, vertices + glyphCount * VERTICES_PER_GLYPH);
+        glyphCount++;
+
         // now advance cursors for next glyph (note that advance is number of 1/64 pixels)
-        x += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+        pen += (ch.Advance >> 6) * scale; // bitshift by 6 to get value in pixels (2^6 = 64)
+    }
+    return glyphCount;
+}
+
+void FontRenderer::drawGlyphs(const GlyphVertex *vertices, size_t glyphCount) {
+    if (glyphCount == 0)
+        return;
+
+    if (profiler)
+        profiler->begin("renderText");
+
+    // activate corresponding render state
+    this->shader.use();
+
+    // Every glyph is in the atlas, so one bind covers all of them
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, font->getAtlasTexture());
+    GLState::bindVertexArray(this->VAO);
+
+    // One upload and one draw per chunk (a chunk is a whole stream region, so usually the whole batch)
+    for (size_t chunk = 0; chunk < glyphCount; chunk += REGION_GLYPHS) {
+        size_t chunkGlyphs = std::min(glyphCount - chunk, REGION_GLYPHS);
+        GLintptr offset = this->vertexStream->append(vertices + chunk * VERTICES_PER_GLYPH,
+                                                     chunkGlyphs * GLYPH_BYTES, VERTEX_BYTES);
+        if (offset >= 0)
+            glDrawArrays(GL_TRIANGLES, static_cast<GLint>(offset / VERTEX_BYTES),
+                         static_cast<GLsizei>(chunkGlyphs * VERTICES_PER_GLYPH));
     }
 
-    glBindVertexArray(0);
-    glBindTexture(GL_TEXTURE_2D, 0);
+    if (profiler)
+        profiler->end();
+}
+
+void FontRenderer::drawVertexArray(GLuint VAO, GLsizei vertexCount) {
+    if (vertexCount == 0)
+        return;
+
+    if (profiler)
+        profiler->begin("renderText");
+
+    this->shader.use();
+    GLState::activeTexture(GL_TEXTURE0);
+    GLState::bindTexture(GL_TEXTURE_2D, font->getAtlasTexture());
+    GLState::bindVertexArray(VAO);
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+
+    if (profiler)
+        profiler->end();
 }
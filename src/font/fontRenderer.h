@@ -4,6 +4,13 @@
 #include "../shader/shaderManager.h"
 #include "../shader/shader.h"
 #include "font.h"
+#include "../shapes/shape.h"
+#include "../renderer/streamBuffer.h"
+#include "../renderer/gpuProfiler.h"
+
+#include <memory>
+#include <string_view>
+#include <vector>
 
 /**
  * @brief A font renderer
@@ -16,27 +23,118 @@ class FontRenderer {
          * @details This constructor will call the font constructor and initialize the render data
          * 
          * @param shader The shader to use
-         * @param fontPath The path to the font file
+         * @param fontPath The font resource (its path inside res/, e.g. "fonts/MxPlus_IBM_BIOS.ttf")
          * @param fontSize The size of the font
+         * @param mode The glyphs the font's atlas stores (SDF needs a shader with textSdf.frag)
          */
-        FontRenderer(Shader& shader, std::string fontPath, int fontSize);
+        FontRenderer(Shader& shader, std::string fontPath, int fontSize, GlyphMode mode = GlyphMode::Bitmap);
 
         /**
          * @brief Destroy the Font Renderer object
-         * @details destroys the VAO and VBO associated with the font renderer
+         * @details destroys the VAO and stream buffer associated with the font renderer
          */
         ~FontRenderer();
 
         /**
          * @brief Renders text on the screen
+         * @details Lays the string out and draws it with one upload and one draw call.
          * 
-         * @param text The text to render
+         * @param text The text to render (only read during the call)
+         * @param x The x position of the text
+         * @param y The y position of the text
+         * @param scale The scale of the text
+         * @param color The color of the text
+         */
+        void renderText(std::string_view text, float x, float y, float scale, glm::vec3 color);
+
+        /**
+         * @brief One glyph vertex <vec2 pos, vec2 tex> + packed color, as text.vert expects it
+         * @details Position, scale and color are baked into the vertices, so glyphs of any number of strings
+         * can be drawn together in one call (see RenderQueue).
+         */
+        struct GlyphVertex {
+            float x, y, u, v;
+            unsigned int color; // RGBA8, see color::pack()
+        };
+
+        /**
+         * @brief Number of vertices of one glyph quad (two triangles)
+         */
+        static const int VERTICES_PER_GLYPH = 6;
+
+        /**
+         * @brief Lays out the glyph quads of a string in screen pixels
+         * @details Touches no GL state and doesn't modify the renderer, so strings can be laid out on worker threads
+         * (see RenderQueue). The text is decoded as UTF-8; characters that weren't requested (see requestGlyphs())
+         * are skipped.
+         *
+         * @param text The text to lay out (UTF-8)
          * @param x The x position of the text
          * @param y The y position of the text
          * @param scale The scale of the text
          * @param color The color of the text
+         * @param vertices Receives VERTICES_PER_GLYPH vertices per glyph (room for text.size() glyphs)
+         * @return The number of glyphs written
+         */
+        size_t layoutText(std::string_view text, float x, float y, float scale, glm::vec3 color, GlyphVertex* vertices) const;
+
+        /**
+         * @brief Pages every character of a string into the font's atlas (see Font::request())
+         * @details Call on the GL thread before the string is laid out (submitting text to the RenderQueue does).
+         */
+        void requestGlyphs(std::string_view text);
+
+        /**
+         * @brief Get the number of glyphs the atlas has evicted (see Font::getGeneration())
+         */
+        unsigned int getAtlasGeneration() const;
+
+        /**
+         * @brief Starts a new frame for the atlas's least recently used bookkeeping (called once per frame)
+         */
+        void endFrame();
+
+        /**
+         * @brief Draws glyphs laid out by layoutText() (from one string or many) with one upload and one draw call
+         *
+         * @param vertices The glyph vertices
+         * @param glyphCount The number of glyphs
+         */
+        void drawGlyphs(const GlyphVertex* vertices, size_t glyphCount);
+
+        /**
+         * @brief Draws glyph vertices that are already in a vertex array (see TextMeshCache)
+         *
+         * @param VAO A vertex array set up with setVertexAttributes()
+         * @param vertexCount The number of vertices to draw
+         */
+        void drawVertexArray(GLuint VAO, GLsizei vertexCount);
+
+        /**
+         * @brief Configures the vertex attributes of the bound VAO for GlyphVertex data in the bound GL_ARRAY_BUFFER
+         */
+        static void setVertexAttributes();
+
+        /**
+         * @brief Get the text shader
+         */
+        const Shader& getShader() const;
+
+        /**
+         * @brief Get the VAO the glyphs are drawn with
+         */
+        GLuint getVAO() const;
+
+        /**
+         * @brief Get the atlas texture the glyphs are sampled from
+         */
+        GLuint getAtlasTexture() const;
+
+        /**
+         * @brief Times every drawGlyphs() call (and so every renderText()) as the "renderText" GPU pass
+         * @param profiler The profiler to report to (nullptr to stop timing)
          */
-        void renderText(std::string text, float x, float y, float scale, glm::vec3 color);
+        void setProfiler(GpuProfiler* profiler);
 
     private:
         /**
@@ -45,20 +143,39 @@ class FontRenderer {
         Shader shader;
 
         /**
-         * @brief The VAO and VBO associated with the font renderer
+         * @brief The VAO associated with the font renderer
+         */
+        GLuint VAO;
+
+        /**
+         * @brief Ring buffer the glyph quads are streamed into
+         */
+        std::unique_ptr<StreamBuffer> vertexStream;
+
+        /**
+         * @brief Profiler renderText() reports to (not owned, may be nullptr)
+         */
+        GpuProfiler* profiler = nullptr;
+
+        /**
+         * @brief Size of one glyph vertex and of one glyph quad (6 vertices)
+         */
+        static const GLsizeiptr VERTEX_BYTES = sizeof(GlyphVertex), GLYPH_BYTES = VERTICES_PER_GLYPH * VERTEX_BYTES;
+
+        /**
+         * @brief Glyphs per stream buffer region, and so the most glyphs uploaded and drawn at once
          */
-        GLuint VAO, VBO;
+        static const size_t REGION_GLYPHS = 1024;
 
         /**
-         * @brief The projection matrix
+         * @brief Scratch space renderText() lays strings out into (kept around to avoid reallocating every call)
          */
-        glm::mat4 projection = glm::ortho(0.0f, 800.0f, 0.0f, 600.0f); // TODO: decide if this should be here or constant in engine class
+        std::vector<GlyphVertex> glyphVertices;
 
         /**
-         * @brief A set of character structs mapped to their ASCII character representations
-         * @details This is the same map generated by the font class
+         * @brief The font and its glyph atlas
          */
-        std::map<char, Character> font;
+        std::unique_ptr<Font> font;
 
         /**
          * @brief Initializes and configures the buffer and vertex attributes
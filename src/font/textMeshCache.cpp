@@ -0,0 +1,86 @@
+#include "textMeshCache.h"
+
+#include "../renderer/glState.h"
+
+TextMeshCache::TextMeshCache(FontRenderer &renderer) : renderer(renderer) {}
+
+TextMeshCache::~TextMeshCache() {
+    for (std::pair<const std::string, TextMesh> &entry : meshes) {
+        GLState::deleteVertexArray(entry.second.VAO);
+        GLState::deleteBuffer(entry.second.VBO);
+    }
+}
+
+std::string TextMeshCache::makeKey(const std::vector<TextLine> &lines) {
+    std::string key;
+    for (const TextLine &line : lines) {
+        key += line.text;
+        // The text can't contain a 0, so this separates it from the numbers that follow
+        key += '\0';
+        float numbers[6] = {line.x, line.y, line.scale, line.color.x, line.color.y, line.color.z};
+        key.append(reinterpret_cast<const char*>(numbers), sizeof(numbers));
+    }
+    return key;
+}
+
+const TextMesh &TextMeshCache::get(const std::vector<TextLine> &lines) {
+    // Keep the block's glyphs in the atlas (this also protects them from eviction for the rest of the frame)
+    for (const TextLine &line : lines)
+        renderer.requestGlyphs(line.text);
+
+    std::string key = makeKey(lines);
+    std::unordered_map<std::string, TextMesh>::iterator it = meshes.find(key);
+    if (it != meshes.end() && it->second.generation == renderer.getAtlasGeneration()) {
+        it->second.lastUsed = frame;
+        return it->second;
+    }
+
+    // Lay out every line of the block into one vertex array
+    size_t glyphs = 0;
+    for (const TextLine &line : lines)
+        glyphs += line.text.size();
+    vertices.resize(glyphs * FontRenderer::VERTICES_PER_GLYPH);
+    size_t glyphCount = 0;
+    for (const TextLine &line : lines)
+        glyphCount += renderer.layoutText(line.text, line.x, line.y, line.scale, line.color,
+                                          vertices.data() + glyphCount * FontRenderer::VERTICES_PER_GLYPH);
+
+    // A stale mesh (the atlas evicted a glyph since) is refilled in place
+    if (it == meshes.end()) {
+        TextMesh mesh{};
+        glGenVertexArrays(1, &mesh.VAO);
+        glGenBuffers(1, &mesh.VBO);
+        GLState::bindVertexArray(mesh.VAO);
+        GLState::bindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+        FontRenderer::setVertexAttributes();
+        it = meshes.emplace(std::move(key), mesh).first;
+    }
+    TextMesh &mesh = it->second;
+    mesh.vertexCount = static_cast<GLsizei>(glyphCount * FontRenderer::VERTICES_PER_GLYPH);
+    mesh.generation = renderer.getAtlasGeneration();
+    mesh.lastUsed = frame;
+    GLState::bindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertexCount * sizeof(FontRenderer::GlyphVertex), vertices.data(), GL_STATIC_DRAW);
+    return mesh;
+}
+
+void TextMeshCache::draw(const TextMesh &mesh) {
+    renderer.drawVertexArray(mesh.VAO, mesh.vertexCount);
+}
+
+void TextMeshCache::endFrame() {
+    frame++;
+    for (std::unordered_map<std::string, TextMesh>::iterator it = meshes.begin(); it != meshes.end();) {
+        if (frame - it->second.lastUsed > MAX_IDLE_FRAMES) {
+            GLState::deleteVertexArray(it->second.VAO);
+            GLState::deleteBuffer(it->second.VBO);
+            it = meshes.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+FontRenderer &TextMeshCache::getRenderer() const {
+    return renderer;
+}
@@ -0,0 +1,114 @@
+#ifndef GRAPHICS_TEXTMESHCACHE_H
+#define GRAPHICS_TEXTMESHCACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include "fontRenderer.h"
+
+/**
+ * @brief One string of a text block, with where and how it is drawn
+ */
+struct TextLine {
+    std::string text;
+    float x, y, scale;
+    glm::vec3 color;
+};
+
+/**
+ * @brief A text block laid out once and kept in its own static vertex buffer
+ */
+struct TextMesh {
+    GLuint VAO, VBO;
+    GLsizei vertexCount;
+    /**
+     * @brief Atlas generation the mesh was laid out against (see Font::getGeneration())
+     */
+    unsigned int generation;
+    /**
+     * @brief Frame the mesh was last requested in (see TextMeshCache::endFrame())
+     */
+    unsigned int lastUsed;
+};
+
+/**
+ * @brief Keeps the meshes of text blocks that don't change from frame to frame
+ * @details A block (the lines of a menu, or the HUD) is keyed by the text, position, scale and color of every line.
+ * The first get() of a block lays it out and uploads it into a GL_STATIC_DRAW buffer; every later get() of the
+ * same block returns that mesh, so an unchanged block costs one draw call and no layout or upload.
+ * When a block changes (e.g. the score), it simply becomes a new key, and the old mesh is deleted by
+ * endFrame() once it hasn't been used for a while. A mesh is also laid out again after the font's atlas evicted
+ * a glyph, since the mesh may point at the cell it was in.
+ */
+class TextMeshCache {
+    public:
+        /**
+         * @brief Construct a new Text Mesh Cache object
+         *
+         * @param renderer The font renderer the blocks are laid out and drawn with
+         */
+        explicit TextMeshCache(FontRenderer& renderer);
+
+        /**
+         * @brief Destroy the Text Mesh Cache object and every cached mesh
+         */
+        ~TextMeshCache();
+
+        TextMeshCache(const TextMeshCache&) = delete;
+        TextMeshCache& operator=(const TextMeshCache&) = delete;
+
+        /**
+         * @brief Returns the mesh of a text block, building it only if this exact block isn't cached
+         * @details The returned mesh stays valid until endFrame() evicts it.
+         *
+         * @param lines The lines of the block
+         */
+        const TextMesh& get(const std::vector<TextLine>& lines);
+
+        /**
+         * @brief Draws a cached mesh with one draw call
+         */
+        void draw(const TextMesh& mesh);
+
+        /**
+         * @brief Deletes the meshes that haven't been used for MAX_IDLE_FRAMES frames
+         * @details Called by the engine once per frame, after drawing.
+         */
+        void endFrame();
+
+        /**
+         * @brief Get the font renderer the blocks are drawn with
+         */
+        FontRenderer& getRenderer() const;
+
+    private:
+        FontRenderer& renderer;
+
+        std::unordered_map<std::string, TextMesh> meshes;
+
+        /**
+         * @brief Number of endFrame() calls so far
+         */
+        unsigned int frame = 0;
+
+        /**
+         * @brief Frames a mesh may go unused before it is deleted
+         */
+        static const unsigned int MAX_IDLE_FRAMES = 60;
+
+        /**
+         * @brief Scratch space blocks are laid out into before the upload
+         */
+        std::vector<FontRenderer::GlyphVertex> vertices;
+
+        /**
+         * @brief Builds the key of a block (the text and the raw position, scale and color of every line)
+         */
+        static std::string makeKey(const std::vector<TextLine>& lines);
+};
+
+#endif //GRAPHICS_TEXTMESHCACHE_H
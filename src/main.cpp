@@ -1,11 +1,62 @@
-
 #include "engine.h"
 
 #include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    void printUsage() {
+        std::cout << "Usage: graphics [--headless [--frames N] [--level 1-4] [--capture file.ppm] [--overdraw] [--back-to-front]]"
+                  << std::endl;
+    }
 
+    /// @brief Parses a whole argument as an integer in [min, max]
+    /// @return false if it isn't a number, has trailing characters or is out of range
+    bool parseNumber(const std::string &text, long min, long max, long &value) {
+        try {
+            size_t end = 0;
+            value = std::stol(text, &end);
+            return end == text.size() && value >= min && value <= max;
+        } catch (const std::logic_error &) { // invalid_argument or out_of_range
+            return false;
+        }
+    }
+}
 
 int main(int argc, char *argv[]) {
-    Engine engine;
+    // --headless [--frames N] [--level 1-4] [--capture file.ppm] [--overdraw] [--back-to-front] renders offscreen (see HeadlessOptions)
+    HeadlessOptions headless;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        long value = 0;
+        if (arg == "--headless")
+            headless.enabled = true;
+        else if (arg == "--frames" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 1000000, value)) {
+                std::cout << "ERROR::MAIN: --frames takes a number of frames (1 or more)" << std::endl;
+                printUsage();
+                return 1;
+            }
+            headless.frames = static_cast<unsigned int>(value);
+        }
+        else if (arg == "--level" && i + 1 < argc) {
+            if (!parseNumber(argv[++i], 1, 4, value)) {
+                std::cout << "ERROR::MAIN: --level takes a level from 1 to 4" << std::endl;
+                printUsage();
+                return 1;
+            }
+            headless.level = static_cast<int>(value);
+        }
+        else if (arg == "--capture" && i + 1 < argc)
+            headless.capturePath = argv[++i];
+        else if (arg == "--overdraw")
+            headless.overdraw = true;
+        else if (arg == "--back-to-front")
+            headless.depthOrdering = false;
+    }
+
+    Engine engine(headless);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
 
     while (!engine.shouldClose()) {
         engine.processInput();
@@ -13,6 +64,18 @@ int main(int argc, char *argv[]) {
         engine.render();
     }
 
+    if (headless.enabled) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << headless.frames << " frames in " << seconds << " s ("
+                  << 1000.0 * seconds / headless.frames << " ms/frame)" << std::endl;
+
+        // Average GPU time of each pass (nested passes are also counted in their parent)
+        const GpuProfiler &profiler = engine.getGpuProfiler();
+        std::cout << "GPU ms/frame over " << profiler.getFrameCount() << " frames:" << std::endl;
+        for (const std::pair<const std::string, double> &pass : profiler.getAverages())
+            std::cout << "  " << pass.first << ": " << pass.second << std::endl;
+    }
+
     glfwTerminate();
     return 0;
 }
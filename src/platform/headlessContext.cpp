@@ -0,0 +1,177 @@
+#ifdef HEADLESS
+
+#include "headlessContext.h"
+#include "../renderer/glState.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+HeadlessContext::HeadlessContext(unsigned int width, unsigned int height) : width(width), height(height) {}
+
+HeadlessContext::~HeadlessContext() {
+    if (!display)
+        return;
+    if (context) {
+        if (FBO) {
+            GLState::deleteFramebuffer(FBO);
+            glDeleteRenderbuffers(1, &colorRBO);
+            glDeleteRenderbuffers(1, &depthStencilRBO);
+        }
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        eglDestroyContext(display, context);
+    }
+    if (surface)
+        eglDestroySurface(display, surface);
+    eglTerminate(display);
+}
+
+bool HeadlessContext::init() {
+    // Prefer Mesa's surfaceless platform: it needs no X11/Wayland server and no GPU device
+    const char *clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (clientExtensions && strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+        auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    }
+    if (!display)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if (!display || !eglInitialize(display, nullptr, nullptr)) {
+        std::cout << "ERROR::HEADLESS: Failed to initialize EGL display" << std::endl;
+        display = nullptr;
+        return false;
+    }
+
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cout << "ERROR::HEADLESS: EGL has no desktop OpenGL support" << std::endl;
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        std::cout << "ERROR::HEADLESS: No suitable EGL config" << std::endl;
+        return false;
+    }
+
+    // Same version and profile as the windowed context
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 3,
+        EGL_CONTEXT_MINOR_VERSION, 3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT) {
+        std::cout << "ERROR::HEADLESS: Failed to create OpenGL 3.3 core context" << std::endl;
+        context = nullptr;
+        return false;
+    }
+
+    // We render into our own framebuffer, so a surface is only needed if the driver insists on one
+    const char *displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!displayExtensions || !strstr(displayExtensions, "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (surface == EGL_NO_SURFACE) {
+            std::cout << "ERROR::HEADLESS: Failed to create pbuffer surface" << std::endl;
+            surface = nullptr;
+            return false;
+        }
+    }
+
+    EGLSurface eglSurface = surface ? surface : EGL_NO_SURFACE;
+    if (!eglMakeCurrent(display, eglSurface, eglSurface, context)) {
+        std::cout << "ERROR::HEADLESS: Failed to make the context current" << std::endl;
+        return false;
+    }
+
+    // glad: load all OpenGL function pointers
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+
+    return initFramebuffer();
+}
+
+bool HeadlessContext::initFramebuffer() {
+    glGenRenderbuffers(1, &colorRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthStencilRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencilRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    glGenFramebuffers(1, &FBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilRBO);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cout << "ERROR::HEADLESS: Offscreen framebuffer is not complete" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void HeadlessContext::present() {
+    // Wait for the GPU to finish the frame, so the ms/frame of a timing run measures rendering, not just submitting
+    glFinish();
+}
+
+bool HeadlessContext::capture(const std::string &path) const {
+    std::vector<unsigned char> pixels(width * height * 3);
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, pixels.data());
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        std::cout << "ERROR::HEADLESS: Could not open " << path << " for writing" << std::endl;
+        return false;
+    }
+    file << "P6\n" << width << " " << height << "\n255\n";
+    // OpenGL rows start at the bottom, PPM rows start at the top
+    for (unsigned int row = height; row-- > 0;)
+        file.write(reinterpret_cast<const char*>(&pixels[row * width * 3]), width * 3);
+    return true;
+}
+
+unsigned int HeadlessContext::getFramebuffer() const {
+    return FBO;
+}
+
+#else
+
+#include "headlessContext.h"
+
+#include <iostream>
+
+// Built without EGL: the engine can still be constructed with headless options, init() just fails.
+HeadlessContext::HeadlessContext(unsigned int width, unsigned int height) : width(width), height(height) {}
+HeadlessContext::~HeadlessContext() {}
+
+bool HeadlessContext::init() {
+    std::cout << "ERROR::HEADLESS: Built without headless support (configure with -DHEADLESS=ON)" << std::endl;
+    return false;
+}
+
+bool HeadlessContext::initFramebuffer() { return false; }
+void HeadlessContext::present() {}
+bool HeadlessContext::capture(const std::string &) const { return false; }
+unsigned int HeadlessContext::getFramebuffer() const { return FBO; }
+
+#endif //HEADLESS
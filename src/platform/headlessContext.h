@@ -0,0 +1,54 @@
+#ifndef GRAPHICS_HEADLESSCONTEXT_H
+#define GRAPHICS_HEADLESSCONTEXT_H
+
+#include <string>
+#include <glad/glad.h>
+
+/// @brief An OpenGL context with no window or display, for benchmark and frame-capture runs.
+/// @details Creates a surfaceless (or, if the driver can't do that, 1x1 pbuffer) OpenGL 3.3 core context through EGL.
+/// This works on Mesa's llvmpipe without a GPU. Everything is rendered into an offscreen framebuffer
+/// with the same color/depth/stencil formats a GLFW window gets by default.
+/// @note Only available when built with -DHEADLESS=ON (which defines HEADLESS and links EGL).
+class HeadlessContext {
+    public:
+        /// @brief Construct a new Headless Context object
+        /// @param width Width of the offscreen framebuffer
+        /// @param height Height of the offscreen framebuffer
+        HeadlessContext(unsigned int width, unsigned int height);
+
+        /// @brief Destroy the Headless Context object, its framebuffer and the EGL context
+        ~HeadlessContext();
+
+        HeadlessContext(const HeadlessContext&) = delete;
+        HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+        /// @brief Creates the EGL context, makes it current, loads OpenGL and binds the offscreen framebuffer
+        /// @return true if successful
+        bool init();
+
+        /// @brief Ends a frame (the headless equivalent of glfwSwapBuffers)
+        /// @details Waits for the GPU to finish the frame (glFinish), so timing runs measure the rendering, not just command submission.
+        void present();
+
+        /// @brief Writes the current contents of the offscreen framebuffer to a binary PPM image
+        /// @param path The file to write
+        /// @return true if the image was written
+        bool capture(const std::string& path) const;
+
+        /// @brief Returns the offscreen framebuffer everything is rendered into
+        unsigned int getFramebuffer() const;
+
+    private:
+        unsigned int width, height;
+
+        /// @brief EGL handles (EGLDisplay, EGLContext, EGLSurface), kept opaque so EGL headers stay out of the engine
+        void *display = nullptr, *context = nullptr, *surface = nullptr;
+
+        /// @brief The offscreen framebuffer and its color and depth/stencil renderbuffers
+        unsigned int FBO = 0, colorRBO = 0, depthStencilRBO = 0;
+
+        /// @brief Creates the offscreen framebuffer
+        bool initFramebuffer();
+};
+
+#endif //GRAPHICS_HEADLESSCONTEXT_H
@@ -0,0 +1,26 @@
+#include "commandList.h"
+
+size_t CommandList::reserveInstances(size_t count) {
+    size_t first = instances.size();
+    instances.resize(first + count);
+    return first;
+}
+
+size_t CommandList::reserveGlyphs(size_t count) {
+    size_t first = glyphVertices.size() / FontRenderer::VERTICES_PER_GLYPH;
+    glyphVertices.resize((first + count) * FontRenderer::VERTICES_PER_GLYPH);
+    return first;
+}
+
+InstancedRenderer::Instance* CommandList::getInstances(size_t first) {
+    return instances.data() + first;
+}
+
+FontRenderer::GlyphVertex* CommandList::getGlyphVertices(size_t first) {
+    return glyphVertices.data() + first * FontRenderer::VERTICES_PER_GLYPH;
+}
+
+void CommandList::clear() {
+    instances.clear();
+    glyphVertices.clear();
+}
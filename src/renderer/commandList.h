@@ -0,0 +1,38 @@
+#ifndef GRAPHICS_COMMANDLIST_H
+#define GRAPHICS_COMMANDLIST_H
+
+#include <cstddef>
+#include <vector>
+
+#include "instancedRenderer.h"
+#include "../font/fontRenderer.h"
+
+using std::vector;
+
+/// @brief The GL-free data of a frame's draws: packed instances and laid out glyphs.
+/// @details Worker threads fill it in parallel and the GL thread replays it (see RenderQueue::flush()).
+/// The GL thread reserves a range for every command first, so each worker only writes its own slice
+/// and no locking is needed. Pointers into the list are valid from the last reservation until clear().
+class CommandList {
+    public:
+        /// @brief Reserves room for count instances and returns the index of the first one
+        size_t reserveInstances(size_t count);
+
+        /// @brief Reserves room for count glyphs and returns the index of the first one
+        size_t reserveGlyphs(size_t count);
+
+        /// @brief Returns the instance at index first (see reserveInstances())
+        InstancedRenderer::Instance* getInstances(size_t first);
+
+        /// @brief Returns the first vertex of the glyph at index first (see reserveGlyphs())
+        FontRenderer::GlyphVertex* getGlyphVertices(size_t first);
+
+        /// @brief Empties the list (keeps the memory for the next frame)
+        void clear();
+
+    private:
+        vector<InstancedRenderer::Instance> instances;
+        vector<FontRenderer::GlyphVertex> glyphVertices;
+};
+
+#endif //GRAPHICS_COMMANDLIST_H
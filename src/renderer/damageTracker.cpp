@@ -0,0 +1,60 @@
+#include "damageTracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+const float DamageTracker::FULL_REDRAW_FRACTION = 0.75f;
+
+DamageTracker::DamageTracker(unsigned int width, unsigned int height) : width(width), height(height), region(0.0f) {}
+
+void DamageTracker::reset() {
+    empty = true;
+    region = vec4(0.0f);
+}
+
+void DamageTracker::add(const vec4 &bounds) {
+    if (empty) {
+        region = bounds;
+        empty = false;
+        return;
+    }
+    region = vec4(std::min(region.x, bounds.x), std::min(region.y, bounds.y),
+                  std::max(region.z, bounds.z), std::max(region.w, bounds.w));
+}
+
+void DamageTracker::invalidate() {
+    add(vec4(0.0f, 0.0f, width, height));
+}
+
+void DamageTracker::track(Shape &shape) {
+    if (!shape.isDirty())
+        return;
+
+    // Uncover where it was, and draw where it is now
+    if (shape.wasDrawn())
+        add(shape.getDrawnBounds());
+    add(shape.getBounds());
+    shape.markDrawn();
+}
+
+bool DamageTracker::isEmpty() const {
+    if (empty)
+        return true;
+    // Damage that is entirely off screen doesn't need a redraw either
+    ivec4 scissor = getScissor();
+    return scissor.z <= 0 || scissor.w <= 0;
+}
+
+bool DamageTracker::isFull() const {
+    ivec4 scissor = getScissor();
+    return float(scissor.z) * float(scissor.w) > FULL_REDRAW_FRACTION * float(width) * float(height);
+}
+
+ivec4 DamageTracker::getScissor() const {
+    // Grow by a pixel on each side for rounding and antialiased edges, then clamp to the screen
+    int left = std::max(0, int(std::floor(region.x)) - 1);
+    int bottom = std::max(0, int(std::floor(region.y)) - 1);
+    int right = std::min(int(width), int(std::ceil(region.z)) + 1);
+    int top = std::min(int(height), int(std::ceil(region.w)) + 1);
+    return ivec4(left, bottom, right - left, top - bottom);
+}
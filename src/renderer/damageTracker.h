@@ -0,0 +1,63 @@
+#ifndef GRAPHICS_DAMAGETRACKER_H
+#define GRAPHICS_DAMAGETRACKER_H
+
+#include <memory>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "../shapes/shape.h"
+
+using std::vector, std::unique_ptr, glm::vec4, glm::ivec4;
+
+/// @brief Collects the parts of the screen that changed since the last redraw.
+/// @details Each frame starts with no damage (reset()). Shapes that moved, resized or changed color add both
+/// where they were drawn last and where they are now, and anything else that changed adds its own bounds.
+/// The damage is kept as the bounding box of all the dirty rectangles, which the engine redraws with glScissor.
+/// When that box covers most of the screen, isFull() tells the engine to redraw the whole frame instead.
+/// @note Bounds are (left, bottom, right, top) in pixels, the same space as shape positions.
+class DamageTracker {
+    public:
+        /// @brief Construct a new Damage Tracker object for a screen of the given size
+        DamageTracker(unsigned int width, unsigned int height);
+
+        /// @brief Starts a new frame with no damage
+        void reset();
+
+        /// @brief Marks a rectangle of the screen as changed
+        /// @param bounds (left, bottom, right, top) in pixels
+        void add(const vec4& bounds);
+
+        /// @brief Marks the whole screen as changed
+        void invalidate();
+
+        /// @brief Adds the old and new bounds of a shape if it changed, then records it as drawn
+        void track(Shape& shape);
+
+        /// @brief Tracks every shape of a layer
+        template <typename T>
+        void track(const vector<unique_ptr<T>>& shapes) {
+            for (const unique_ptr<T>& shape : shapes)
+                track(*shape);
+        }
+
+        /// @brief Returns true if nothing changed (the previous frame can be shown again as is)
+        bool isEmpty() const;
+
+        /// @brief Returns true if the damage covers enough of the screen that a full redraw is simpler
+        bool isFull() const;
+
+        /// @brief Returns the damage as a scissor box (x, y, width, height), clamped to the screen
+        ivec4 getScissor() const;
+
+    private:
+        unsigned int width, height;
+
+        /// @brief Bounding box of the damage (left, bottom, right, top)
+        vec4 region;
+        bool empty = true;
+
+        /// @brief Damage above this fraction of the screen is redrawn as a full frame
+        static const float FULL_REDRAW_FRACTION;
+};
+
+#endif //GRAPHICS_DAMAGETRACKER_H
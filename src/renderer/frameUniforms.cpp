@@ -0,0 +1,22 @@
+#include "frameUniforms.h"
+
+#include "glState.h"
+
+FrameUniforms::FrameUniforms() {
+    glGenBuffers(1, &UBO);
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, UBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), nullptr, GL_DYNAMIC_DRAW);
+    // The binding point keeps the buffer, so this is the only bind the block ever needs
+    glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, UBO);
+}
+
+FrameUniforms::~FrameUniforms() {
+    GLState::deleteBuffer(UBO);
+}
+
+void FrameUniforms::update(const Data &data) {
+    GLState::bindBuffer(GL_UNIFORM_BUFFER, UBO);
+    // Orphan last frame's storage so we don't wait on draws that are still reading it
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(Data), nullptr, GL_DYNAMIC_DRAW);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Data), &data);
+}
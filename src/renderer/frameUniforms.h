@@ -0,0 +1,53 @@
+#ifndef GRAPHICS_FRAMEUNIFORMS_H
+#define GRAPHICS_FRAMEUNIFORMS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+/// @brief The std140 "FrameData" uniform block every program shares, with the constants of a whole frame.
+/// @details The projection, viewport and time are written into one uniform buffer once per frame and bound to
+/// BINDING, so no draw uploads them as plain uniforms and every program sees the same projection.
+/// Shader binds the block of each program it links to BINDING (see Shader::bindUniformBlocks()).
+/// Shaders declare it as:
+///
+///     layout (std140) uniform FrameData {
+///         mat4 projection;
+///         vec2 viewport;  // size of the screen in pixels
+///         float time;     // seconds since the engine started
+///     };
+class FrameUniforms {
+    public:
+        /// @brief Name of the block in the shaders
+        static constexpr const char* BLOCK_NAME = "FrameData";
+
+        /// @brief Uniform buffer binding point the block is bound to
+        static const GLuint BINDING = 0;
+
+        /// @brief The block, laid out exactly as std140 lays it out in the shaders
+        struct Data {
+            glm::mat4 projection;
+            glm::vec2 viewport;
+            float time;
+            float padding; // std140 rounds the block up to a multiple of vec4
+        };
+        static_assert(sizeof(Data) == 80, "FrameUniforms::Data must match the std140 layout of FrameData");
+
+        /// @brief Construct a new Frame Uniforms object
+        /// @details Creates the uniform buffer and binds it to BINDING.
+        FrameUniforms();
+
+        /// @brief Destroy the Frame Uniforms object and delete its buffer
+        ~FrameUniforms();
+
+        FrameUniforms(const FrameUniforms&) = delete;
+        FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+        /// @brief Uploads the constants of a frame (called once, before anything is drawn)
+        void update(const Data& data);
+
+    private:
+        /// @brief The uniform buffer
+        unsigned int UBO;
+};
+
+#endif //GRAPHICS_FRAMEUNIFORMS_H
@@ -0,0 +1,148 @@
+#include "glState.h"
+
+unsigned int GLState::program = GLState::UNKNOWN;
+unsigned int GLState::vertexArray = GLState::UNKNOWN;
+unsigned int GLState::buffers[GLState::BUFFER_SLOTS] = {UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN};
+unsigned int GLState::activeUnit = GLState::UNKNOWN;
+unsigned int GLState::textures[GLState::TEXTURE_UNITS] = {
+    UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN,
+    UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN, UNKNOWN
+};
+unsigned int GLState::drawFramebuffer = 0;
+unsigned int GLState::readFramebuffer = 0;
+GLStateStats GLState::stats;
+
+bool GLState::unchanged(unsigned int &cached, unsigned int value) {
+    if (cached == value) {
+        stats.skipped++;
+        return true;
+    }
+    cached = value;
+    stats.issued++;
+    return false;
+}
+
+int GLState::bufferSlot(GLenum target) {
+    switch (target) {
+        case GL_ARRAY_BUFFER:         return ARRAY;
+        case GL_ELEMENT_ARRAY_BUFFER: return ELEMENT_ARRAY;
+        case GL_UNIFORM_BUFFER:       return UNIFORM;
+        case GL_PIXEL_UNPACK_BUFFER:  return PIXEL_UNPACK;
+        default:                      return BUFFER_SLOTS;
+    }
+}
+
+void GLState::useProgram(unsigned int ID) {
+    if (!unchanged(program, ID))
+        glUseProgram(ID);
+}
+
+void GLState::bindVertexArray(unsigned int VAO) {
+    if (unchanged(vertexArray, VAO))
+        return;
+    glBindVertexArray(VAO);
+    // The element array binding belongs to the VAO we just switched to
+    buffers[ELEMENT_ARRAY] = UNKNOWN;
+}
+
+void GLState::bindBuffer(GLenum target, unsigned int buffer) {
+    int slot = bufferSlot(target);
+    if (slot == BUFFER_SLOTS) {
+        stats.issued++;
+        glBindBuffer(target, buffer);
+        return;
+    }
+    if (!unchanged(buffers[slot], buffer))
+        glBindBuffer(target, buffer);
+}
+
+void GLState::activeTexture(GLenum unit) {
+    if (!unchanged(activeUnit, unit - GL_TEXTURE0))
+        glActiveTexture(unit);
+}
+
+void GLState::bindTexture(GLenum target, unsigned int texture) {
+    // Until activeTexture() is called (again, after invalidate()) we don't know which unit this binds to,
+    // so the binding is issued but not recorded
+    if (target != GL_TEXTURE_2D || activeUnit >= TEXTURE_UNITS) {
+        stats.issued++;
+        glBindTexture(target, texture);
+        return;
+    }
+    if (!unchanged(textures[activeUnit], texture))
+        glBindTexture(target, texture);
+}
+
+void GLState::bindFramebuffer(GLenum target, unsigned int framebuffer) {
+    bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+    bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+    if ((!draw || drawFramebuffer == framebuffer) && (!read || readFramebuffer == framebuffer)) {
+        stats.skipped++;
+        return;
+    }
+    if (draw)
+        drawFramebuffer = framebuffer;
+    if (read)
+        readFramebuffer = framebuffer;
+    stats.issued++;
+    glBindFramebuffer(target, framebuffer);
+}
+
+unsigned int GLState::getDrawFramebuffer() {
+    return drawFramebuffer;
+}
+
+void GLState::deleteProgram(unsigned int ID) {
+    if (program == ID)
+        program = UNKNOWN;
+    glDeleteProgram(ID);
+}
+
+void GLState::deleteVertexArray(unsigned int VAO) {
+    if (vertexArray == VAO) {
+        vertexArray = UNKNOWN;
+        buffers[ELEMENT_ARRAY] = UNKNOWN;
+    }
+    glDeleteVertexArrays(1, &VAO);
+}
+
+void GLState::deleteBuffer(unsigned int buffer) {
+    for (unsigned int &bound : buffers)
+        if (bound == buffer)
+            bound = UNKNOWN;
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLState::deleteTexture(unsigned int texture) {
+    for (unsigned int &bound : textures)
+        if (bound == texture)
+            bound = UNKNOWN;
+    glDeleteTextures(1, &texture);
+}
+
+void GLState::deleteFramebuffer(unsigned int framebuffer) {
+    // Deleting a bound framebuffer reverts the binding to the default framebuffer
+    if (drawFramebuffer == framebuffer)
+        drawFramebuffer = 0;
+    if (readFramebuffer == framebuffer)
+        readFramebuffer = 0;
+    glDeleteFramebuffers(1, &framebuffer);
+}
+
+void GLState::invalidate() {
+    program = UNKNOWN;
+    vertexArray = UNKNOWN;
+    activeUnit = UNKNOWN;
+    for (unsigned int &bound : buffers)
+        bound = UNKNOWN;
+    for (unsigned int &bound : textures)
+        bound = UNKNOWN;
+}
+
+GLStateStats GLState::getStats() {
+    return stats;
+}
+
+void GLState::resetStats() {
+    stats = GLStateStats();
+}
@@ -0,0 +1,90 @@
+#ifndef GRAPHICS_GLSTATE_H
+#define GRAPHICS_GLSTATE_H
+
+#include <glad/glad.h>
+
+/// @brief Counters kept by GLState.
+/// @details issued counts state calls that reached the driver, skipped counts redundant calls that were elided.
+struct GLStateStats {
+    unsigned int issued = 0;
+    unsigned int skipped = 0;
+};
+
+/// @brief Shadow copy of the OpenGL binding state.
+/// @details Every program, VAO, buffer and texture bind in the project goes through this class,
+/// so a bind is only sent to the driver when the bound object actually changes.
+/// Objects must also be deleted through it, otherwise a recycled ID could be mistaken for a stale binding.
+/// @note Only one GL context is ever used, so the state is static.
+class GLState {
+    public:
+        /// @brief glUseProgram, skipped if the program is already in use
+        static void useProgram(unsigned int program);
+
+        /// @brief glBindVertexArray, skipped if the VAO is already bound
+        static void bindVertexArray(unsigned int VAO);
+
+        /// @brief glBindBuffer, skipped if the buffer is already bound to the target
+        /// @details GL_ELEMENT_ARRAY_BUFFER is part of the VAO, so it is only tracked until the next VAO change.
+        static void bindBuffer(GLenum target, unsigned int buffer);
+
+        /// @brief glActiveTexture, skipped if the texture unit is already active
+        static void activeTexture(GLenum unit);
+
+        /// @brief glBindTexture on the active texture unit, skipped if the texture is already bound
+        /// @details Always issued while the active unit is unknown (before activeTexture(), or after invalidate()).
+        static void bindTexture(GLenum target, unsigned int texture);
+
+        /// @brief glBindFramebuffer, skipped if the framebuffer is already bound
+        /// @details GL_FRAMEBUFFER binds both the draw and the read framebuffer.
+        static void bindFramebuffer(GLenum target, unsigned int framebuffer);
+
+        /// @brief Returns the framebuffer currently bound for drawing (0 is the default framebuffer)
+        static unsigned int getDrawFramebuffer();
+
+        // --------------------------------------------------------
+        // Deletion (deletes the object and forgets any binding to it)
+        // --------------------------------------------------------
+        static void deleteProgram(unsigned int program);
+        static void deleteVertexArray(unsigned int VAO);
+        static void deleteBuffer(unsigned int buffer);
+        static void deleteTexture(unsigned int texture);
+        static void deleteFramebuffer(unsigned int framebuffer);
+
+        /// @brief Forgets all cached bindings
+        /// @details Call this after code that binds objects without going through GLState.
+        /// Framebuffer bindings are kept, since getDrawFramebuffer() must always return a real framebuffer.
+        static void invalidate();
+
+        /// @brief Returns the issued/skipped counters since the last resetStats()
+        static GLStateStats getStats();
+
+        /// @brief Resets the issued/skipped counters (done by the engine at the start of every frame)
+        static void resetStats();
+
+    private:
+        /// @brief Marks a binding as unknown, so the next bind is always issued
+        static const unsigned int UNKNOWN = ~0u;
+
+        /// @brief Number of texture units tracked
+        static const int TEXTURE_UNITS = 16;
+
+        /// @brief Buffer targets tracked (other targets are always forwarded to the driver)
+        enum BufferSlot { ARRAY, ELEMENT_ARRAY, UNIFORM, PIXEL_UNPACK, BUFFER_SLOTS };
+
+        static unsigned int program;
+        static unsigned int vertexArray;
+        static unsigned int buffers[BUFFER_SLOTS];
+        static unsigned int activeUnit;
+        static unsigned int textures[TEXTURE_UNITS];
+        static unsigned int drawFramebuffer;
+        static unsigned int readFramebuffer;
+        static GLStateStats stats;
+
+        /// @brief Maps a buffer target to its slot, or BUFFER_SLOTS if it isn't tracked
+        static int bufferSlot(GLenum target);
+
+        /// @brief Returns true (and counts a skip) if the cached value already matches, otherwise stores it
+        static bool unchanged(unsigned int &cached, unsigned int value);
+};
+
+#endif //GRAPHICS_GLSTATE_H
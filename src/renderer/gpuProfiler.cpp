@@ -0,0 +1,111 @@
+#include "gpuProfiler.h"
+
+GpuProfiler::~GpuProfiler() {
+    release(current);
+    for (FrameQueries &frame : pending)
+        release(frame);
+    if (!freeQueries.empty())
+        glDeleteQueries(static_cast<GLsizei>(freeQueries.size()), freeQueries.data());
+}
+
+void GpuProfiler::beginFrame() {
+    if (frameStarted)
+        pending.push_back(std::move(current));
+    current = FrameQueries();
+    openRanges.clear();
+    frameStarted = true;
+
+    // Collect every finished frame in order; the first unfinished one (and everything after it) waits for later
+    while (!pending.empty() && collect(pending.front())) {
+        release(pending.front());
+        pending.pop_front();
+    }
+    // Don't let a stalled GPU grow the backlog forever
+    while (pending.size() > MAX_PENDING_FRAMES) {
+        release(pending.front());
+        pending.pop_front();
+    }
+}
+
+void GpuProfiler::begin(const string &pass) {
+    // Work before the first frame (the background bakes at startup) belongs to no frame, so it isn't timed
+    if (!frameStarted)
+        return;
+    current.ranges.push_back({pass, nextQuery(), 0});
+    glQueryCounter(current.ranges.back().begin, GL_TIMESTAMP);
+    openRanges.push_back(current.ranges.size() - 1);
+}
+
+void GpuProfiler::end() {
+    if (openRanges.empty())
+        return;
+
+    Range &range = current.ranges[openRanges.back()];
+    openRanges.pop_back();
+    range.end = nextQuery();
+    glQueryCounter(range.end, GL_TIMESTAMP);
+}
+
+GLuint GpuProfiler::nextQuery() {
+    GLuint query;
+    if (freeQueries.empty()) {
+        glGenQueries(1, &query);
+    } else {
+        query = freeQueries.back();
+        freeQueries.pop_back();
+    }
+    current.queries.push_back(query);
+    return query;
+}
+
+void GpuProfiler::release(FrameQueries &frame) {
+    freeQueries.insert(freeQueries.end(), frame.queries.begin(), frame.queries.end());
+    frame.queries.clear();
+}
+
+bool GpuProfiler::collect(const FrameQueries &frame) {
+    if (frame.ranges.empty())
+        return true;
+
+    // Timestamps are written in order, so if the last one is ready they all are
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries.back(), GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+        return false;
+
+    timings.clear();
+    for (const Range &range : frame.ranges) {
+        // A pass that never ended (end == 0) has no result
+        if (range.end == 0)
+            continue;
+        GLuint64 begin, end;
+        glGetQueryObjectui64v(range.begin, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(range.end, GL_QUERY_RESULT, &end);
+        // Timestamps are in nanoseconds
+        double ms = static_cast<double>(end - begin) / 1000000.0;
+        timings[range.pass] += ms;
+        totals[range.pass] += ms;
+    }
+    frameCount++;
+    return true;
+}
+
+double GpuProfiler::getMilliseconds(const string &pass) const {
+    map<string, double>::const_iterator it = timings.find(pass);
+    return it == timings.end() ? 0.0 : it->second;
+}
+
+const map<string, double> &GpuProfiler::getTimings() const {
+    return timings;
+}
+
+map<string, double> GpuProfiler::getAverages() const {
+    map<string, double> averages;
+    for (const std::pair<const string, double> &total : totals)
+        averages[total.first] = frameCount == 0 ? 0.0 : total.second / frameCount;
+    return averages;
+}
+
+unsigned int GpuProfiler::getFrameCount() const {
+    return frameCount;
+}
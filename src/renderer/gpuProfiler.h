@@ -0,0 +1,101 @@
+#ifndef GRAPHICS_GPUPROFILER_H
+#define GRAPHICS_GPUPROFILER_H
+
+#include <glad/glad.h>
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+using std::vector, std::string, std::map;
+
+/// @brief Measures how much GPU time named passes of a frame take, using GL_TIMESTAMP queries.
+/// @details Each begin()/end() pair writes a timestamp before and after the pass. Passes may nest,
+/// and passes with the same name are summed over the frame (e.g. every renderText() call).
+/// A frame's queries stay pending until the GPU has written them: beginFrame() reads back every pending frame
+/// that is ready, oldest first, and leaves the rest for later, so reading the results never stalls the CPU and a GPU
+/// running a few frames behind (as software GL often does) loses no results. Only a GPU more than
+/// MAX_PENDING_FRAMES frames behind has its oldest frames dropped.
+class GpuProfiler {
+    public:
+        GpuProfiler() = default;
+
+        /// @brief Destroy the GPU Profiler object and delete its query objects
+        ~GpuProfiler();
+
+        GpuProfiler(const GpuProfiler&) = delete;
+        GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+        /// @brief Starts a new frame and collects the results of every earlier frame the GPU has finished
+        /// @details Called by the engine at the start of every frame.
+        void beginFrame();
+
+        /// @brief Starts timing a pass
+        /// @details Ignored before the first beginFrame(), like the end() that goes with it.
+        /// @param pass The name the pass is reported under
+        void begin(const string& pass);
+
+        /// @brief Stops timing the most recently started pass
+        void end();
+
+        /// @brief Returns the GPU milliseconds of a pass in the latest collected frame (0 if it didn't run)
+        double getMilliseconds(const string& pass) const;
+
+        /// @brief Returns the GPU milliseconds of every pass in the latest collected frame
+        const map<string, double>& getTimings() const;
+
+        /// @brief Returns the average GPU milliseconds per collected frame of every pass seen so far
+        map<string, double> getAverages() const;
+
+        /// @brief Returns the number of frames collected so far (frames that weren't ready are not counted)
+        unsigned int getFrameCount() const;
+
+    private:
+        /// @brief A timed pass: the pass name and its begin and end timestamp queries
+        struct Range {
+            string pass;
+            GLuint begin, end;
+        };
+
+        /// @brief The queries issued during one frame
+        struct FrameQueries {
+            /// @brief Query objects, in the order their timestamps were written
+            vector<GLuint> queries;
+            vector<Range> ranges;
+        };
+
+        /// @brief Most frames kept waiting for their results before the oldest is dropped
+        static const size_t MAX_PENDING_FRAMES = 8;
+
+        /// @brief The frame being recorded
+        FrameQueries current;
+
+        /// @brief Earlier frames whose results the GPU hasn't written yet, oldest first
+        std::deque<FrameQueries> pending;
+
+        /// @brief Query objects of collected (or dropped) frames, reused before new ones are created
+        vector<GLuint> freeQueries;
+
+        /// @brief False until the first beginFrame(), so passes run at startup don't open ranges in no frame
+        bool frameStarted = false;
+
+        /// @brief Indices (into the current frame's ranges) of the passes that have begun but not ended
+        vector<size_t> openRanges;
+
+        map<string, double> timings;
+        map<string, double> totals;
+        unsigned int frameCount = 0;
+
+        /// @brief Returns a query for the current frame, reusing a free one if there is any
+        GLuint nextQuery();
+
+        /// @brief Reads back a frame's queries if the GPU has written them all
+        /// @return false if they aren't ready yet (the frame stays pending)
+        bool collect(const FrameQueries& frame);
+
+        /// @brief Returns a frame's query objects to freeQueries
+        void release(FrameQueries& frame);
+};
+
+#endif //GRAPHICS_GPUPROFILER_H
@@ -0,0 +1,61 @@
+#include "instancedRenderer.h"
+
+#include <cstddef>
+
+#include "glState.h"
+
+InstancedRenderer::InstancedRenderer(Shader &shader, ShapeKind kind) : shader(shader), mesh(GeometryCache::get(kind)) {
+    initRenderData();
+}
+
+InstancedRenderer::~InstancedRenderer() {
+    GLState::deleteVertexArray(VAO);
+    GLState::deleteBuffer(instanceVBO);
+}
+
+void InstancedRenderer::initRenderData() {
+    glGenVertexArrays(1, &VAO);
+    GLState::bindVertexArray(VAO);
+
+    // Reuse the unit mesh every shape of this kind is drawn with
+    GLState::bindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+
+    // Instance attributes advance once per instance (divisor 1) instead of once per vertex
+    glGenBuffers(1, &instanceVBO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, transform));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    // The packed color stays an integer in the shader (note the I in glVertexAttribIPointer)
+    glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(Instance), (void*)offsetof(Instance, color));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+}
+
+const Shader &InstancedRenderer::getShader() const {
+    return shader;
+}
+
+unsigned int InstancedRenderer::getVAO() const {
+    return VAO;
+}
+
+void InstancedRenderer::drawInstances(const Instance *data, size_t count) {
+    if (count == 0)
+        return;
+
+    GLState::bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    // Grow the buffer with headroom so a slightly larger layer doesn't reallocate again
+    if (count > capacity)
+        capacity = count * 2;
+    // Orphan the old storage so we don't wait on a draw that is still reading it
+    glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(Instance), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Instance), data);
+
+    this->shader.use();
+    GLState::bindVertexArray(VAO);
+    glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, static_cast<GLsizei>(count));
+}
@@ -0,0 +1,89 @@
+#ifndef GRAPHICS_INSTANCEDRENDERER_H
+#define GRAPHICS_INSTANCEDRENDERER_H
+
+#include <memory>
+#include <vector>
+
+#include "../shader/shader.h"
+#include "../shapes/shape.h"
+#include "../shapes/geometry.h"
+
+using std::vector, std::unique_ptr;
+
+/// @brief Draws a whole layer of shapes with a single instanced draw call.
+/// @details Every shape in a layer shares one unit mesh from GeometryCache. Only the position, size and packed color
+/// of each shape (20 bytes) are uploaded into a per-instance buffer, then the whole layer is drawn
+/// with one glDrawElementsInstanced call instead of one setUniforms() + draw() pair per shape.
+/// The shader decides what the mesh looks like (e.g. circle.frag turns the quad into a circle).
+class InstancedRenderer {
+    public:
+        /// @brief Construct a new Instanced Renderer object
+        /// @details Creates the VAO and the (initially empty) instance buffer.
+        /// @param shader The instanced shader to use (see res/shaders/instanced.vert)
+        /// @param kind The unit mesh every instance is drawn with
+        explicit InstancedRenderer(Shader& shader, ShapeKind kind = ShapeKind::Rect);
+
+        /// @brief Destroy the Instanced Renderer object and delete its VAO and instance buffer
+        ~InstancedRenderer();
+
+        InstancedRenderer(const InstancedRenderer&) = delete;
+        InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+
+        /// @brief Per-instance data, laid out exactly as the instance attributes in instanced.vert
+        struct Instance {
+            vec4 transform;     // xy = center, zw = size
+            unsigned int color; // RGBA8, see color::pack()
+        };
+
+        /// @brief Packs the instance data of shapes[begin, end) into out
+        /// @details Touches no GL state, so slices of a layer can be recorded on worker threads (see RenderQueue).
+        template <typename T>
+        static void record(const vector<unique_ptr<T>>& shapes, size_t begin, size_t end, Instance* out) {
+            for (size_t i = begin; i < end; ++i) {
+                const T& s = *shapes[i];
+                *out++ = {vec4(s.getPosX(), s.getPosY(), s.getSize().x, s.getSize().y), color::pack(s.getColor4())};
+            }
+        }
+
+        /// @brief Draws every shape in the layer with one instanced draw call
+        /// @details Shapes are drawn in vector order, so later shapes are drawn on top.
+        /// @param shapes The layer of shapes to draw (any Shape subclass)
+        template <typename T>
+        void draw(const vector<unique_ptr<T>>& shapes) {
+            instances.resize(shapes.size());
+            record(shapes, 0, shapes.size(), instances.data());
+            drawInstances(instances.data(), instances.size());
+        }
+
+        /// @brief Uploads already recorded instances and draws them with one instanced draw call
+        /// @param data The instances (see record())
+        /// @param count The number of instances
+        void drawInstances(const Instance* data, size_t count);
+
+        /// @brief Returns the instanced shader
+        const Shader& getShader() const;
+
+        /// @brief Returns the VAO the instances are drawn with
+        unsigned int getVAO() const;
+
+    private:
+        /// @brief Shader used to draw all instances.
+        Shader& shader;
+
+        /// @brief The shared unit mesh the instances are drawn with.
+        const Mesh& mesh;
+
+        /// @brief The VAO (unit mesh + instance attributes) and the per-instance VBO.
+        unsigned int VAO, instanceVBO;
+
+        /// @brief Number of instances the instance VBO currently has room for.
+        size_t capacity = 0;
+
+        /// @brief CPU-side staging for draw() (kept around to avoid reallocating every frame).
+        vector<Instance> instances;
+
+        /// @brief Attaches the shared unit mesh and configures the vertex and instance attributes
+        void initRenderData();
+};
+
+#endif //GRAPHICS_INSTANCEDRENDERER_H
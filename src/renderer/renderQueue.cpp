@@ -0,0 +1,217 @@
+#include "renderQueue.h"
+#include "glState.h"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+
+RenderQueue::RenderQueue(WorkerPool *workers) : workers(workers) {}
+
+uint64_t RenderQueue::makeKey(uint8_t layer, bool opaque, unsigned int shader, unsigned int geometry, unsigned int texture, uint16_t sequence) {
+    // Opaque layers are inverted so the nearest one sorts first
+    uint8_t order = opaque ? (0x7F - (layer & 0x7F)) : (0x80 | (layer & 0x7F));
+    return (uint64_t(order) << 56) |
+           (uint64_t(shader & 0xFF) << 48) |
+           (uint64_t(geometry & 0xFFFF) << 32) |
+           (uint64_t(texture & 0xFFFF) << 16) |
+           uint64_t(sequence);
+}
+
+uint16_t RenderQueue::nextSequence() const {
+    return static_cast<uint16_t>(commands.size());
+}
+
+void RenderQueue::submit(uint8_t layer, const Shape &shape, bool opaque) {
+    RenderCommand command{};
+    command.key = makeKey(layer, opaque && depthOrdering, shape.getShader().ID, shape.getMesh().VAO, 0, nextSequence());
+    command.layer = layer;
+    command.type = SHAPE;
+    command.shape = &shape;
+    commands.push_back(command);
+}
+
+void RenderQueue::submitText(uint8_t layer, FontRenderer &renderer, std::string_view text, float x, float y, float scale, vec3 color) {
+    RenderCommand command{};
+    command.key = makeKey(layer, false, renderer.getShader().ID, renderer.getVAO(), renderer.getAtlasTexture(), nextSequence());
+    command.layer = layer;
+    command.type = TEXT;
+    command.text = texts.size();
+    // Page in any glyphs the atlas doesn't have now, on the GL thread, so recording only reads the font
+    renderer.requestGlyphs(text);
+    commands.push_back(command);
+    texts.push_back({&renderer, textChars.size(), text.size(), x, y, scale, color});
+    textChars.insert(textChars.end(), text.begin(), text.end());
+}
+
+void RenderQueue::submitTextMesh(uint8_t layer, TextMeshCache &cache, const TextMesh &mesh) {
+    const FontRenderer &renderer = cache.getRenderer();
+    RenderCommand command{};
+    command.key = makeKey(layer, false, renderer.getShader().ID, mesh.VAO, renderer.getAtlasTexture(), nextSequence());
+    command.layer = layer;
+    command.type = TEXT_MESH;
+    command.textMeshCache = &cache;
+    command.textMesh = &mesh;
+    commands.push_back(command);
+}
+
+size_t RenderQueue::size() const {
+    return commands.size();
+}
+
+void RenderQueue::record() {
+    // Reserve every command's range up front, so the jobs can write their slices without locking
+    recorded.clear();
+    jobs.clear();
+    size_t items = 0;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        RenderCommand &command = commands[i];
+        if (command.type == INSTANCED) {
+            command.count = command.countShapes(command.shapes);
+            command.first = recorded.reserveInstances(command.count);
+            for (size_t begin = 0; begin < command.count; begin += SLICE_SIZE)
+                jobs.push_back({i, begin, std::min(begin + SLICE_SIZE, command.count)});
+            items += command.count;
+        } else if (command.type == TEXT) {
+            command.count = texts[command.text].length;
+            command.first = recorded.reserveGlyphs(command.count);
+            jobs.push_back({i, 0, 0});
+            items += command.count;
+        }
+    }
+
+    std::function<void(size_t)> runJob = [this](size_t j) {
+        const RecordJob &job = jobs[j];
+        RenderCommand &command = commands[job.command];
+        if (command.type == INSTANCED) {
+            command.recordInstances(command.shapes, job.begin, job.end, recorded.getInstances(command.first + job.begin));
+        } else {
+            const TextCommand &text = texts[command.text];
+            FontRenderer::GlyphVertex *vertices = recorded.getGlyphVertices(command.first);
+            size_t glyphs = text.renderer->layoutText(std::string_view(textChars.data() + text.offset, text.length),
+                                                      text.x, text.y, text.scale, text.color, vertices);
+            // Characters that aren't in the atlas (and the extra bytes of UTF-8 sequences) leave zero-area quads, so the range stays contiguous for batching
+            std::fill(vertices + glyphs * FontRenderer::VERTICES_PER_GLYPH,
+                      vertices + command.count * FontRenderer::VERTICES_PER_GLYPH, FontRenderer::GlyphVertex{});
+        }
+    };
+    if (workers && items >= MIN_PARALLEL_ITEMS) {
+        workers->run(jobs.size(), runJob);
+    } else {
+        for (size_t j = 0; j < jobs.size(); ++j)
+            runJob(j);
+    }
+}
+
+void RenderQueue::flush() {
+    std::sort(commands.begin(), commands.end(),
+              [](const RenderCommand &a, const RenderCommand &b) { return a.key < b.key; });
+
+    record();
+
+    if (depthOrdering)
+        glEnable(GL_DEPTH_TEST);
+    else
+        glDisable(GL_DEPTH_TEST);
+
+    // Layers are contiguous after sorting, so each one is timed as a single pass
+    int currentLayer = -1;
+    bool blending = true;
+    unsigned int currentProgram = 0;
+    int depthLocation = -1;
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const RenderCommand &command = commands[i];
+        if (profiler && command.layer != currentLayer) {
+            if (currentLayer != -1)
+                profiler->end();
+            profiler->begin(static_cast<size_t>(command.layer) < layerNames.size() ? layerNames[command.layer] : "layer " + std::to_string(command.layer));
+            currentLayer = command.layer;
+        }
+
+        // Opaque commands sort first, so blending is turned off and back on at most once per flush
+        bool opaque = (command.key >> 63) == 0;
+        if (opaque == blending) {
+            blending = !opaque;
+            if (blending)
+                glEnable(GL_BLEND);
+            else
+                glDisable(GL_BLEND);
+        }
+
+        // Every command's program gets its layer's depth (nearer layers are closer to the viewer)
+        // Commands are sorted by program within a layer, so the location is only fetched when the program changes
+        const Shader &shader = getShader(command);
+        GLState::useProgram(shader.ID);
+        if (shader.ID != currentProgram) {
+            currentProgram = shader.ID;
+            depthLocation = getDepthLocation(shader);
+        }
+        shader.setFloat(depthLocation, command.layer / 128.0f);
+
+        switch (command.type) {
+            case SHAPE:
+                command.shape->setUniforms();
+                command.shape->draw();
+                break;
+            case INSTANCED:
+                command.instancedRenderer->drawInstances(recorded.getInstances(command.first), command.count);
+                break;
+            case TEXT: {
+                // The following strings of the same layer and font were recorded right after this one,
+                // so they are drawn together with a single upload and draw call
+                FontRenderer *renderer = texts[command.text].renderer;
+                size_t glyphs = command.count;
+                while (i + 1 < commands.size() && commands[i + 1].type == TEXT && commands[i + 1].layer == command.layer &&
+                       texts[commands[i + 1].text].renderer == renderer)
+                    glyphs += commands[++i].count;
+                renderer->drawGlyphs(recorded.getGlyphVertices(command.first), glyphs);
+                break;
+            }
+            case TEXT_MESH:
+                command.textMeshCache->draw(*command.textMesh);
+                break;
+        }
+    }
+
+    if (profiler && currentLayer != -1)
+        profiler->end();
+    if (!blending)
+        glEnable(GL_BLEND);
+
+    commands.clear();
+    texts.clear();
+    textChars.clear();
+}
+
+int RenderQueue::getDepthLocation(const Shader &shader) {
+    std::unordered_map<unsigned int, int>::iterator it = depthLocations.find(shader.ID);
+    if (it == depthLocations.end())
+        it = depthLocations.emplace(shader.ID, shader.getUniformLocation("depth")).first;
+    return it->second;
+}
+
+const Shader &RenderQueue::getShader(const RenderCommand &command) const {
+    switch (command.type) {
+        case SHAPE:
+            return command.shape->getShader();
+        case INSTANCED:
+            return command.instancedRenderer->getShader();
+        case TEXT_MESH:
+            return command.textMeshCache->getRenderer().getShader();
+        case TEXT:
+        default:
+            return texts[command.text].renderer->getShader();
+    }
+}
+
+void RenderQueue::setProfiler(GpuProfiler *profiler, vector<string> layerNames) {
+    this->profiler = profiler;
+    this->layerNames = std::move(layerNames);
+}
+
+void RenderQueue::setDepthOrdering(bool enabled) {
+    depthOrdering = enabled;
+}
+
+bool RenderQueue::getDepthOrdering() const {
+    return depthOrdering;
+}
@@ -0,0 +1,174 @@
+#ifndef GRAPHICS_RENDERQUEUE_H
+#define GRAPHICS_RENDERQUEUE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../shapes/shape.h"
+#include "../shapes/rect.h"
+#include "../font/fontRenderer.h"
+#include "../font/textMeshCache.h"
+#include "instancedRenderer.h"
+#include "gpuProfiler.h"
+#include "commandList.h"
+#include "workerPool.h"
+
+using std::vector, std::unique_ptr, std::string;
+
+/// @brief Collects the draws of one frame and dispatches them in sort-key order.
+/// @details Each command gets a 64-bit key laid out (from most to least significant) as
+/// pass (1 bit) | layer (7 bits) | shader (8 bits) | geometry (16 bits) | texture (16 bits) | submission order (16 bits).
+/// Opaque commands come first (pass 0) with their layers inverted, so they are drawn front to back with blending off,
+/// and the depth test (each layer writes its own "depth" uniform) rejects the pixels hidden behind them
+/// before they are shaded. Translucent commands follow (pass 1) back to front, tested against the same depth.
+/// Inside a layer, draws are grouped by program, then by VAO, then by texture, so consecutive commands mostly
+/// skip their state changes (see GLState). Draws in the same layer with the same state keep the order they were submitted in.
+///
+/// flush() runs in two phases. Recording packs the instances of every instanced layer (in slices) and lays out
+/// every string into a CommandList; with a WorkerPool and enough work, the slices run on worker threads.
+/// Replaying then walks the sorted commands on the GL thread, which only uploads the recorded data and draws.
+/// Consecutive strings of the same layer and font are replayed as a single draw.
+class RenderQueue {
+    public:
+        /// @brief Construct a new Render Queue object
+        /// @param workers Threads to record on (nullptr to record on the calling thread)
+        explicit RenderQueue(WorkerPool* workers = nullptr);
+
+        /// @brief Builds a sort key
+        /// @param layer Draw layer (0-127, lower layers are further back)
+        /// @param opaque True to sort the command into the front-to-back opaque pass
+        /// @param shader Program ID of the command
+        /// @param geometry VAO of the command
+        /// @param texture Texture of the command (0 if none, or if it changes during the command)
+        /// @param sequence Submission order, used to keep equal commands stable
+        static uint64_t makeKey(uint8_t layer, bool opaque, unsigned int shader, unsigned int geometry, unsigned int texture, uint16_t sequence);
+
+        /// @brief Queues a single shape (setUniforms() + draw())
+        /// @param opaque True if the shape covers every pixel of its mesh with alpha 1 (it is then drawn front to back)
+        void submit(uint8_t layer, const Shape& shape, bool opaque = false);
+
+        /// @brief Queues a whole layer of shapes drawn by an instanced renderer
+        /// @details The vector is drawn as it is when flush() runs, not copied.
+        /// @param opaque True if every shape covers every pixel of its mesh with alpha 1 (it is then drawn front to back)
+        template <typename T>
+        void submit(uint8_t layer, InstancedRenderer& renderer, const vector<unique_ptr<T>>& shapes, bool opaque = false) {
+            RenderCommand command{};
+            command.key = makeKey(layer, opaque && depthOrdering, renderer.getShader().ID, renderer.getVAO(), 0, nextSequence());
+            command.layer = layer;
+            command.type = INSTANCED;
+            command.instancedRenderer = &renderer;
+            command.shapes = &shapes;
+            // Remember the element type, so flush() can hand the vector back to the templated record()
+            command.countShapes = [](const void *s) {
+                return static_cast<const vector<unique_ptr<T>>*>(s)->size();
+            };
+            command.recordInstances = [](const void *s, size_t begin, size_t end, InstancedRenderer::Instance *out) {
+                InstancedRenderer::record(*static_cast<const vector<unique_ptr<T>>*>(s), begin, end, out);
+            };
+            commands.push_back(command);
+        }
+
+        /// @brief Queues a string of text
+        /// @details The characters are copied into the frame's text buffer, so temporaries can be submitted.
+        /// Text is always translucent.
+        void submitText(uint8_t layer, FontRenderer& renderer, std::string_view text, float x, float y, float scale, vec3 color);
+
+        /// @brief Queues a text block that is already laid out and uploaded (see TextMeshCache::get())
+        /// @details Nothing is recorded for it; it is drawn straight from its own buffer with one draw call.
+        void submitTextMesh(uint8_t layer, TextMeshCache& cache, const TextMesh& mesh);
+
+        /// @brief Sorts the queued commands, draws them and empties the queue
+        void flush();
+
+        /// @brief Returns the number of commands queued since the last flush()
+        size_t size() const;
+
+        /// @brief Times every layer flush() draws as a GPU pass
+        /// @param profiler The profiler to report to (nullptr to stop timing)
+        /// @param layerNames The pass name of each layer (index = layer)
+        void setProfiler(GpuProfiler* profiler, vector<string> layerNames);
+
+        /// @brief Turns the front-to-back opaque pass and the depth test on or off
+        /// @details When off, every command is drawn back to front like a painter (for comparing overdraw).
+        void setDepthOrdering(bool enabled);
+
+        /// @brief Returns true if opaque commands are drawn front to back with the depth test
+        bool getDepthOrdering() const;
+
+    private:
+        enum CommandType { SHAPE, INSTANCED, TEXT, TEXT_MESH };
+
+        /// @brief A queued draw. Only the members used by its type are set.
+        struct RenderCommand {
+            uint64_t key;
+            uint8_t layer;
+            CommandType type;
+            const Shape* shape;
+            InstancedRenderer* instancedRenderer;
+            const void* shapes;
+            size_t (*countShapes)(const void*);
+            void (*recordInstances)(const void*, size_t, size_t, InstancedRenderer::Instance*);
+            size_t text;
+            TextMeshCache* textMeshCache;
+            const TextMesh* textMesh;
+            /// @brief Where the command's recorded instances or glyphs are in the command list, and how many
+            size_t first, count;
+        };
+
+        /// @brief A piece of recording work: shapes [begin, end) of an instanced command, or a whole string
+        struct RecordJob {
+            size_t command;
+            size_t begin, end;
+        };
+
+        /// @brief Instances per recording job
+        static const size_t SLICE_SIZE = 256;
+
+        /// @brief Below this many instances and glyphs in a frame, waking the workers costs more than it saves
+        static const size_t MIN_PARALLEL_ITEMS = 1024;
+
+        /// @brief A queued string (kept separately so commands stay small to sort)
+        struct TextCommand {
+            FontRenderer* renderer;
+            /// @brief Where the characters are in textChars
+            size_t offset, length;
+            float x, y, scale;
+            vec3 color;
+        };
+
+        vector<RenderCommand> commands;
+        vector<TextCommand> texts;
+
+        /// @brief Characters of every string queued this frame, back to back (one allocation instead of one per string)
+        vector<char> textChars;
+
+        GpuProfiler* profiler = nullptr;
+        vector<string> layerNames;
+
+        bool depthOrdering = true;
+
+        /// @brief Location of the "depth" uniform of every program drawn so far, keyed by program ID
+        std::unordered_map<unsigned int, int> depthLocations;
+
+        WorkerPool* workers;
+        CommandList recorded;
+        vector<RecordJob> jobs;
+
+        /// @brief Records the instances and glyphs of every queued command into the command list
+        void record();
+
+        /// @brief Returns the program a command draws with
+        const Shader& getShader(const RenderCommand& command) const;
+
+        /// @brief Returns the location of a program's "depth" uniform, looking it up by name only the first time
+        int getDepthLocation(const Shader& shader);
+
+        /// @brief Returns the submission order of the next command
+        uint16_t nextSequence() const;
+};
+
+#endif //GRAPHICS_RENDERQUEUE_H
@@ -0,0 +1,45 @@
+#include "sceneBuffer.h"
+#include "glState.h"
+
+#include <iostream>
+
+SceneBuffer::SceneBuffer(unsigned int width, unsigned int height) : width(width), height(height) {
+    glGenRenderbuffers(1, &colorRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &depthStencilRBO);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthStencilRBO);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    unsigned int previous = GLState::getDrawFramebuffer();
+    glGenFramebuffers(1, &FBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthStencilRBO);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::SCENEBUFFER: Framebuffer is not complete" << std::endl;
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, previous);
+}
+
+SceneBuffer::~SceneBuffer() {
+    GLState::deleteFramebuffer(FBO);
+    glDeleteRenderbuffers(1, &colorRBO);
+    glDeleteRenderbuffers(1, &depthStencilRBO);
+}
+
+void SceneBuffer::bind() const {
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, FBO);
+}
+
+void SceneBuffer::blitTo(unsigned int framebuffer) const {
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+    GLState::bindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    // Keep reads (e.g. frame captures) pointed at the framebuffer we copied to
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+}
+
+unsigned int SceneBuffer::getFramebuffer() const {
+    return FBO;
+}
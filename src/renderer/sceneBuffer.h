@@ -0,0 +1,38 @@
+#ifndef GRAPHICS_SCENEBUFFER_H
+#define GRAPHICS_SCENEBUFFER_H
+
+#include <glad/glad.h>
+
+/// @brief An offscreen color + depth/stencil framebuffer that keeps its contents from frame to frame.
+/// @details The window's back buffer is undefined after a swap, so partial redraws (see DamageTracker) go here
+/// instead, and the finished frame is copied to the screen with blitTo().
+class SceneBuffer {
+    public:
+        /// @brief Construct a new Scene Buffer object
+        /// @details Creates the framebuffer with an RGBA8 color and a DEPTH24_STENCIL8 renderbuffer.
+        /// @param width Width in pixels (should match the window)
+        /// @param height Height in pixels (should match the window)
+        SceneBuffer(unsigned int width, unsigned int height);
+
+        /// @brief Destroy the Scene Buffer object and its framebuffer and renderbuffers
+        ~SceneBuffer();
+
+        SceneBuffer(const SceneBuffer&) = delete;
+        SceneBuffer& operator=(const SceneBuffer&) = delete;
+
+        /// @brief Binds the scene buffer for drawing and reading
+        void bind() const;
+
+        /// @brief Copies the whole scene into a framebuffer with a single blit, and binds that framebuffer
+        /// @param framebuffer The framebuffer to copy to (0 is the window)
+        void blitTo(unsigned int framebuffer) const;
+
+        /// @brief Returns the framebuffer ID
+        unsigned int getFramebuffer() const;
+
+    private:
+        unsigned int width, height;
+        unsigned int FBO, colorRBO, depthStencilRBO;
+};
+
+#endif //GRAPHICS_SCENEBUFFER_H
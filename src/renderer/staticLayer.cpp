@@ -0,0 +1,54 @@
+#include "staticLayer.h"
+#include "glState.h"
+
+#include <iostream>
+
+StaticLayer::StaticLayer(unsigned int width, unsigned int height) : width(width), height(height) {
+    glGenTextures(1, &texture);
+    GLState::bindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    unsigned int previous = GLState::getDrawFramebuffer();
+    glGenFramebuffers(1, &FBO);
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::STATICLAYER: Framebuffer is not complete" << std::endl;
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, previous);
+}
+
+StaticLayer::~StaticLayer() {
+    GLState::deleteFramebuffer(FBO);
+    GLState::deleteTexture(texture);
+}
+
+void StaticLayer::beginBake(const glm::vec4& clearColor) {
+    previousFramebuffer = GLState::getDrawFramebuffer();
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, FBO);
+    glViewport(0, 0, width, height);
+    glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void StaticLayer::endBake() {
+    GLState::bindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+    baked = true;
+}
+
+void StaticLayer::restore() const {
+    unsigned int target = GLState::getDrawFramebuffer();
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, FBO);
+    glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    // Keep reads (e.g. frame captures) pointed at the framebuffer we draw to
+    GLState::bindFramebuffer(GL_READ_FRAMEBUFFER, target);
+}
+
+bool StaticLayer::isBaked() const {
+    return baked;
+}
+
+unsigned int StaticLayer::getTexture() const {
+    return texture;
+}
@@ -0,0 +1,52 @@
+#ifndef GRAPHICS_STATICLAYER_H
+#define GRAPHICS_STATICLAYER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+/// @brief A screen-sized layer that is rendered once and then restored every frame.
+/// @details Draws between beginBake() and endBake() go into an offscreen color texture instead of the screen.
+/// restore() then copies that texture into the current framebuffer with a single blit. This replaces the clear plus
+/// all the draws of geometry that never moves, which matters on software rasterizers where fill is the bottleneck.
+class StaticLayer {
+    public:
+        /// @brief Construct a new Static Layer object
+        /// @details Creates the framebuffer and its color texture.
+        /// @param width Width of the layer in pixels (should match the window)
+        /// @param height Height of the layer in pixels (should match the window)
+        StaticLayer(unsigned int width, unsigned int height);
+
+        /// @brief Destroy the Static Layer object and its framebuffer and texture
+        ~StaticLayer();
+
+        StaticLayer(const StaticLayer&) = delete;
+        StaticLayer& operator=(const StaticLayer&) = delete;
+
+        /// @brief Redirects drawing into the layer and clears it
+        /// @param clearColor Color the layer is cleared to before baking
+        void beginBake(const glm::vec4& clearColor);
+
+        /// @brief Stops drawing into the layer and rebinds the framebuffer that was bound in beginBake()
+        void endBake();
+
+        /// @brief Copies the baked layer over the whole current draw framebuffer
+        /// @details This overwrites every pixel, so no clear is needed before it.
+        void restore() const;
+
+        /// @brief Returns true once the layer has been baked
+        bool isBaked() const;
+
+        /// @brief Returns the color texture of the layer
+        unsigned int getTexture() const;
+
+    private:
+        unsigned int width, height;
+        unsigned int FBO, texture;
+
+        /// @brief Framebuffer to go back to in endBake()
+        unsigned int previousFramebuffer = 0;
+
+        bool baked = false;
+};
+
+#endif //GRAPHICS_STATICLAYER_H
@@ -0,0 +1,80 @@
+#include "streamBuffer.h"
+#include "glState.h"
+
+#include <cstring>
+#include <iostream>
+
+StreamBuffer::StreamBuffer(GLenum target, GLsizeiptr regionSize, int regionCount) :
+    target(target), regionSize(regionSize), regionCount(regionCount), fences(regionCount, nullptr) {
+    glGenBuffers(1, &ID);
+    GLState::bindBuffer(target, ID);
+    glBufferData(target, regionSize * regionCount, nullptr, GL_STREAM_DRAW);
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (GLsync fence : fences)
+        if (fence)
+            glDeleteSync(fence);
+    GLState::deleteBuffer(ID);
+}
+
+void StreamBuffer::nextRegion() {
+    // Everything drawn from the current region has been issued, so fence it
+    fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    region = (region + 1) % regionCount;
+    head = 0;
+
+    // Only blocks if the GPU is still reading the region from regionCount regions ago
+    GLsync fence = fences[region];
+    if (fence) {
+        GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+        while (glClientWaitSync(fence, flags, 1000000) == GL_TIMEOUT_EXPIRED)
+            flags = 0;
+        glDeleteSync(fence);
+        fences[region] = nullptr;
+    }
+}
+
+void* StreamBuffer::map(GLsizeiptr size, GLsizeiptr alignment, GLintptr& offset) {
+    if (size > regionSize) {
+        std::cout << "ERROR::STREAMBUFFER: Write of " << size << " bytes is larger than a region ("
+                  << regionSize << " bytes)" << std::endl;
+        return nullptr;
+    }
+
+    // Align relative to the whole buffer, so offset / alignment is a whole number
+    GLsizeiptr base = region * regionSize;
+    GLsizeiptr aligned = ((base + head + alignment - 1) / alignment) * alignment - base;
+    if (aligned + size > regionSize) {
+        nextRegion();
+        base = region * regionSize;
+        aligned = ((base + alignment - 1) / alignment) * alignment - base;
+    }
+
+    offset = base + aligned;
+    head = aligned + size;
+
+    // Unsynchronized: the fences guarantee the GPU isn't reading this range anymore
+    GLState::bindBuffer(target, ID);
+    return glMapBufferRange(target, offset, size,
+                            GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+void StreamBuffer::unmap() {
+    GLState::bindBuffer(target, ID);
+    glUnmapBuffer(target);
+}
+
+GLintptr StreamBuffer::append(const void* data, GLsizeiptr size, GLsizeiptr alignment) {
+    GLintptr offset;
+    void* ptr = map(size, alignment, offset);
+    if (!ptr)
+        return -1;
+    std::memcpy(ptr, data, size);
+    unmap();
+    return offset;
+}
+
+unsigned int StreamBuffer::getID() const {
+    return ID;
+}
@@ -0,0 +1,65 @@
+#ifndef GRAPHICS_STREAMBUFFER_H
+#define GRAPHICS_STREAMBUFFER_H
+
+#include <vector>
+#include <glad/glad.h>
+
+using std::vector;
+
+/// @brief A ring of buffer regions for geometry that is rewritten every frame.
+/// @details Writes are appended with unsynchronized glMapBufferRange calls, so they never wait on draws
+/// that are still reading earlier data. When a region fills up it is protected by a fence and the ring moves
+/// on to the next region, only waiting if the GPU hasn't finished with that region yet (i.e. it is regionCount regions behind).
+class StreamBuffer {
+    public:
+        /// @brief Construct a new Stream Buffer object
+        /// @param target The buffer target the data is used as (e.g. GL_ARRAY_BUFFER)
+        /// @param regionSize Size of one region in bytes (the largest single write that fits)
+        /// @param regionCount Number of regions in the ring
+        StreamBuffer(GLenum target, GLsizeiptr regionSize, int regionCount = 3);
+
+        /// @brief Destroy the Stream Buffer object, its buffer and any pending fences
+        ~StreamBuffer();
+
+        StreamBuffer(const StreamBuffer&) = delete;
+        StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+        /// @brief Reserves space in the ring and maps it for writing
+        /// @details The mapping must be released with unmap() before drawing from it.
+        /// @param size Number of bytes to reserve
+        /// @param alignment Alignment of the returned offset (use the vertex stride so offset / stride is a vertex index)
+        /// @param offset Set to the byte offset of the reserved space inside the buffer
+        /// @return Pointer to write the data to, or nullptr if size doesn't fit in a region
+        void* map(GLsizeiptr size, GLsizeiptr alignment, GLintptr& offset);
+
+        /// @brief Releases the mapping returned by map()
+        void unmap();
+
+        /// @brief Copies data into the ring (map() + memcpy + unmap())
+        /// @param data The data to copy
+        /// @param size Number of bytes to copy
+        /// @param alignment Alignment of the returned offset
+        /// @return The byte offset of the data inside the buffer, or -1 if it doesn't fit in a region
+        GLintptr append(const void* data, GLsizeiptr size, GLsizeiptr alignment = 1);
+
+        /// @brief Returns the GL buffer object (to attach to a VAO)
+        unsigned int getID() const;
+
+    private:
+        GLenum target;
+        unsigned int ID;
+        GLsizeiptr regionSize;
+        int regionCount;
+
+        /// @brief The region currently written to and the write position inside it
+        int region = 0;
+        GLsizeiptr head = 0;
+
+        /// @brief One fence per region, set when the ring moves past the region (nullptr if none pending)
+        vector<GLsync> fences;
+
+        /// @brief Fences the current region and moves to the next one, waiting for the GPU to release it if needed
+        void nextRegion();
+};
+
+#endif //GRAPHICS_STREAMBUFFER_H
@@ -0,0 +1,70 @@
+#include "workerPool.h"
+
+WorkerPool::WorkerPool(unsigned int threadCount) {
+    for (unsigned int i = 0; i < threadCount; ++i)
+        threads.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+void WorkerPool::run(size_t jobCount, const std::function<void(size_t)> &job) {
+    // Not worth waking anyone up for
+    if (threads.empty() || jobCount <= 1) {
+        for (size_t i = 0; i < jobCount; ++i)
+            job(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        this->jobCount = jobCount;
+        nextJob = 0;
+        busy = static_cast<unsigned int>(threads.size());
+        generation++;
+    }
+    wake.notify_all();
+
+    // The calling thread works too instead of just waiting
+    runJobs();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busy == 0; });
+    this->job = nullptr;
+}
+
+unsigned int WorkerPool::getThreadCount() const {
+    return static_cast<unsigned int>(threads.size());
+}
+
+void WorkerPool::workerLoop() {
+    unsigned int seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+
+        runJobs();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busy == 0)
+            done.notify_one();
+    }
+}
+
+void WorkerPool::runJobs() {
+    for (size_t i = nextJob++; i < jobCount; i = nextJob++)
+        (*job)(i);
+}
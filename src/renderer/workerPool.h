@@ -0,0 +1,59 @@
+#ifndef GRAPHICS_WORKERPOOL_H
+#define GRAPHICS_WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+/// @brief A fixed set of worker threads that run batches of independent jobs.
+/// @details run() hands out job indices to the workers and to the calling thread, and returns once every job
+/// has finished. Jobs must not touch OpenGL: only the thread that owns the context may (see RenderQueue).
+class WorkerPool {
+    public:
+        /// @brief Construct a new Worker Pool object and start its threads
+        /// @param threadCount Number of worker threads (the calling thread also runs jobs, so cores - 1 is enough)
+        explicit WorkerPool(unsigned int threadCount);
+
+        /// @brief Stops and joins every worker thread
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        /// @brief Runs job(0) ... job(jobCount - 1) in parallel and waits for all of them
+        void run(size_t jobCount, const std::function<void(size_t)>& job);
+
+        /// @brief Returns the number of worker threads (not counting the calling thread)
+        unsigned int getThreadCount() const;
+
+    private:
+        vector<std::thread> threads;
+
+        std::mutex mutex;
+        std::condition_variable wake, done;
+
+        /// @brief The batch being run (only valid during run())
+        const std::function<void(size_t)>* job = nullptr;
+        size_t jobCount = 0;
+        std::atomic<size_t> nextJob{0};
+
+        /// @brief Bumped for every batch, so each worker joins every batch exactly once
+        unsigned int generation = 0;
+        /// @brief Workers still running the current batch
+        unsigned int busy = 0;
+        bool stopping = false;
+
+        /// @brief Waits for batches until the pool is destroyed
+        void workerLoop();
+
+        /// @brief Takes jobs of the current batch until there are none left
+        void runJobs();
+};
+
+#endif //GRAPHICS_WORKERPOOL_H
@@ -0,0 +1,110 @@
+#include "programCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include "../util/hash.h"
+
+namespace {
+    /// @brief Start of a cached program file, followed by the binary
+    struct BinaryHeader {
+        char magic[4];
+        uint32_t format;
+        uint32_t length;
+    };
+
+    const char BINARY_MAGIC[4] = {'P', 'R', 'G', 'B'};
+}
+
+ProgramCache::ProgramCache(std::string directory) : directory(std::move(directory)) {}
+
+bool ProgramCache::isSupported() const {
+    if (!GLAD_GL_VERSION_4_1 && !GLAD_GL_ARB_get_program_binary)
+        return false;
+    // Some drivers expose the entry points but no binary format at all
+    int formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+uint64_t ProgramCache::makeKey(const char *vertexSource, const char *fragmentSource, const char *geometrySource) const {
+    // A separator after each part, so moving text from one shader to the next changes the key
+    const char separator = 0;
+    uint64_t key = hash::FNV_OFFSET;
+    for (const char *source : {vertexSource, fragmentSource, geometrySource}) {
+        if (source)
+            key = hash::fnv1a(key, source, std::strlen(source));
+        key = hash::fnv1a(key, &separator, 1);
+    }
+    for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+        const char *value = reinterpret_cast<const char*>(glGetString(name));
+        if (value)
+            key = hash::fnv1a(key, value, std::strlen(value));
+        key = hash::fnv1a(key, &separator, 1);
+    }
+    return key;
+}
+
+std::string ProgramCache::getPath(uint64_t key) const {
+    std::stringstream name;
+    name << directory << "/" << std::hex << key << ".bin";
+    return name.str();
+}
+
+bool ProgramCache::load(Shader &shader, uint64_t key) const {
+    if (!isSupported())
+        return false;
+
+    std::string path = getPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+
+    BinaryHeader header;
+    bool valid = data.size() >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, data.data(), sizeof(header));
+        valid = std::memcmp(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC)) == 0 &&
+                data.size() == sizeof(header) + header.length &&
+                shader.loadBinary(header.format, data.data() + sizeof(header), static_cast<GLsizei>(header.length));
+    }
+    if (!valid) {
+        // Rejected (usually a driver update the version string didn't reveal); it is rewritten after compiling
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+    return valid;
+}
+
+void ProgramCache::store(const Shader &shader, uint64_t key) const {
+    if (!isSupported())
+        return;
+
+    int length = 0;
+    glGetProgramiv(shader.ID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(shader.ID, length, &length, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    std::ofstream file(getPath(key), std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cout << "ERROR::PROGRAMCACHE: Could not write " << getPath(key) << std::endl;
+        return;
+    }
+    BinaryHeader header;
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(BINARY_MAGIC));
+    header.format = format;
+    header.length = static_cast<uint32_t>(length);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), length);
+}
@@ -0,0 +1,41 @@
+#ifndef GRAPHICS_PROGRAMCACHE_H
+#define GRAPHICS_PROGRAMCACHE_H
+
+#include <cstdint>
+#include <string>
+
+#include "shader.h"
+
+/// @brief Keeps the linked binaries of shader programs on disk, so later launches skip compiling and linking.
+/// @details Each program is stored in its own file, named after a key that hashes its sources together with the
+/// driver's vendor, renderer and version strings, so editing a shader or updating the driver simply misses.
+/// The driver may still reject a binary (glProgramBinary fails to link), in which case the program is compiled
+/// from source and the file is rewritten. Needs GL 4.1 or ARB_get_program_binary; without them every call misses.
+class ProgramCache {
+    public:
+        /// @brief Construct a new Program Cache object
+        /// @param directory Where the binaries are stored (relative to the working directory, i.e. the build directory)
+        explicit ProgramCache(std::string directory = "shadercache");
+
+        /// @brief Returns true if the driver can save and load program binaries
+        bool isSupported() const;
+
+        /// @brief Hashes the sources of a program and the driver's identity into a cache key
+        /// @param geometrySource The geometry shader source (nullptr if none)
+        uint64_t makeKey(const char* vertexSource, const char* fragmentSource, const char* geometrySource) const;
+
+        /// @brief Links a shader from its cached binary
+        /// @return false if there is no binary for the key, or the driver rejected it (the stale file is then removed)
+        bool load(Shader& shader, uint64_t key) const;
+
+        /// @brief Saves the binary of a linked shader under a key
+        void store(const Shader& shader, uint64_t key) const;
+
+    private:
+        std::string directory;
+
+        /// @brief Returns the file a key is stored in
+        std::string getPath(uint64_t key) const;
+};
+
+#endif //GRAPHICS_PROGRAMCACHE_H
@@ -1,85 +1,208 @@
 #include "shader.h"
+#include "../renderer/glState.h"
+#include "../renderer/frameUniforms.h"
 
 Shader &Shader::use() {
-    glUseProgram(this->ID);
+    GLState::useProgram(this->ID);
     return *this;
 }
 
 void Shader::compile(const char* vertexSource, const char* fragmentSource, const char* geometrySource) {
-    unsigned int sVertex, sFragment, gShader;
+    beginCompile(vertexSource, fragmentSource, geometrySource);
+    finishCompile();
+}
+
+void Shader::beginCompile(const char* vertexSource, const char* fragmentSource, const char* geometrySource) {
+    pendingStages.clear();
 
     // vertex Shader
-    sVertex = glCreateShader(GL_VERTEX_SHADER);
+    unsigned int sVertex = glCreateShader(GL_VERTEX_SHADER);
     glShaderSource(sVertex, 1, &vertexSource, NULL);
     glCompileShader(sVertex);
-    checkCompileErrors(sVertex, "VERTEX");
+    pendingStages.emplace_back(sVertex, "VERTEX");
 
     // fragment Shader
-    sFragment = glCreateShader(GL_FRAGMENT_SHADER);
+    unsigned int sFragment = glCreateShader(GL_FRAGMENT_SHADER);
     glShaderSource(sFragment, 1, &fragmentSource, NULL);
     glCompileShader(sFragment);
-    checkCompileErrors(sFragment, "FRAGMENT");
+    pendingStages.emplace_back(sFragment, "FRAGMENT");
 
     // if geometry shader source code is given, also compile geometry shader
     if (geometrySource != nullptr) {
-        gShader = glCreateShader(GL_GEOMETRY_SHADER);
+        unsigned int gShader = glCreateShader(GL_GEOMETRY_SHADER);
         glShaderSource(gShader, 1, &geometrySource, NULL);
         glCompileShader(gShader);
-        checkCompileErrors(gShader, "GEOMETRY");
+        pendingStages.emplace_back(gShader, "GEOMETRY");
     }
 
-    // shader program
+    // shader program (linking doesn't need the compile results yet, so nothing waits here)
     this->ID = glCreateProgram();
-    glAttachShader(this->ID, sVertex);
-    glAttachShader(this->ID, sFragment);
-    if (geometrySource != nullptr)
-        glAttachShader(this->ID, gShader);
+    for (const std::pair<unsigned int, string> &stage : pendingStages)
+        glAttachShader(this->ID, stage.first);
+
+    // let the driver know we'll ask for the binary (see ProgramCache)
+    if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+        glProgramParameteri(this->ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
     glLinkProgram(this->ID);
+}
+
+bool Shader::isCompileDone() const {
+    if (!hasParallelCompile())
+        return true;
+    int done = GL_FALSE;
+    glGetProgramiv(this->ID, GL_COMPLETION_STATUS_KHR, &done);
+    return done == GL_TRUE;
+}
+
+void Shader::finishCompile() {
+    for (const std::pair<unsigned int, string> &stage : pendingStages)
+        checkCompileErrors(stage.first, stage.second);
     checkCompileErrors(this->ID, "PROGRAM");
+    cacheUniformLocations();
+    bindUniformBlocks();
 
     // delete the shaders as they're linked into our program now and no longer necessary
-    glDeleteShader(sVertex);
-    glDeleteShader(sFragment);
-    if (geometrySource != nullptr)
-        glDeleteShader(gShader);
+    for (const std::pair<unsigned int, string> &stage : pendingStages)
+        glDeleteShader(stage.first);
+    pendingStages.clear();
+}
+
+bool Shader::hasParallelCompile() {
+    static const bool supported = [] {
+        int count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (int i = 0; i < count; i++) {
+            const char *extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+            // the ARB version has the same completion status query
+            if (extension && (string(extension) == "GL_KHR_parallel_shader_compile" ||
+                              string(extension) == "GL_ARB_parallel_shader_compile"))
+                return true;
+        }
+        return false;
+    }();
+    return supported;
+}
+
+bool Shader::loadBinary(GLenum format, const void *binary, GLsizei length) {
+    this->ID = glCreateProgram();
+    glProgramBinary(this->ID, format, binary, length);
+
+    // a rejected binary is expected (e.g. after a driver update), so it isn't reported as an error
+    int success = 0;
+    glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
+    if (!success) {
+        GLState::deleteProgram(this->ID);
+        this->ID = 0;
+        return false;
+    }
+    cacheUniformLocations();
+    bindUniformBlocks();
+    return true;
+}
+
+int Shader::getUniformLocation(const char *name) const {
+    auto iter = uniformLocations.find(name);
+    return iter != uniformLocations.end() ? iter->second : -1;
+}
+
+void Shader::cacheUniformLocations() {
+    uniformLocations.clear();
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    string name(maxLength, '\0');
+    for (int i = 0; i < count; i++) {
+        int length = 0, size = 0;
+        GLenum type;
+        glGetActiveUniform(this->ID, i, maxLength, &length, &size, &type, &name[0]);
+        string uniformName = name.substr(0, length);
+        int location = glGetUniformLocation(this->ID, uniformName.c_str());
+        // members of uniform blocks have no location
+        if (location == -1)
+            continue;
+        uniformLocations[uniformName] = location;
+        // arrays are reported as "name[0]", but are usually looked up as "name"
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            uniformLocations[uniformName.substr(0, uniformName.size() - 3)] = location;
+    }
+}
+
+void Shader::bindUniformBlocks() {
+    // block bindings aren't part of the program binary, so this runs however the program was made
+    unsigned int index = glGetUniformBlockIndex(this->ID, FrameUniforms::BLOCK_NAME);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(this->ID, index, FrameUniforms::BINDING);
 }
 
 void Shader::setFloat(const char *name, float value) const {
-    glUniform1f(glGetUniformLocation(this->ID, name), value);
+    setFloat(getUniformLocation(name), value);
 }
 
 void Shader::setInteger(const char *name, int value) const {
-    glUniform1i(glGetUniformLocation(this->ID, name), value);
+    setInteger(getUniformLocation(name), value);
+}
 
+void Shader::setUnsignedInteger(const char *name, unsigned int value) const {
+    setUnsignedInteger(getUniformLocation(name), value);
 }
 
 void Shader::setVector2f(const char *name, float x, float y) const {
-    glUniform2f(glGetUniformLocation(this->ID, name), x, y);
+    setVector2f(getUniformLocation(name), glm::vec2(x, y));
 }
 
 void Shader::setVector2f(const char *name, const glm::vec2 &value) const {
-    glUniform2f(glGetUniformLocation(this->ID, name), value.x, value.y);
+    setVector2f(getUniformLocation(name), value);
 }
 
 void Shader::setVector3f(const char *name, float x, float y, float z) const {
-    glUniform3f(glGetUniformLocation(this->ID, name), x, y, z);
+    setVector3f(getUniformLocation(name), glm::vec3(x, y, z));
 }
 
 void Shader::setVector3f(const char *name, const glm::vec3 &value) const {
-    glUniform3f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z);
+    setVector3f(getUniformLocation(name), value);
 }
 
 void Shader::setVector4f(const char *name, float x, float y, float z, float w) const {
-    glUniform4f(glGetUniformLocation(this->ID, name), x, y, z, w);
+    setVector4f(getUniformLocation(name), glm::vec4(x, y, z, w));
 }
 
 void Shader::setVector4f(const char *name, const glm::vec4 &value) const {
-    glUniform4f(glGetUniformLocation(this->ID, name), value.x, value.y, value.z, value.w);
+    setVector4f(getUniformLocation(name), value);
 }
 
 void Shader::setMatrix4(const char *name, const glm::mat4 &matrix) const {
-    glUniformMatrix4fv(glGetUniformLocation(this->ID, name), 1, false, glm::value_ptr(matrix));
+    setMatrix4(getUniformLocation(name), matrix);
+}
+
+void Shader::setFloat(int location, float value) const {
+    glUniform1f(location, value);
+}
+
+void Shader::setInteger(int location, int value) const {
+    glUniform1i(location, value);
+}
+
+void Shader::setUnsignedInteger(int location, unsigned int value) const {
+    glUniform1ui(location, value);
+}
+
+void Shader::setVector2f(int location, const glm::vec2 &value) const {
+    glUniform2f(location, value.x, value.y);
+}
+
+void Shader::setVector3f(int location, const glm::vec3 &value) const {
+    glUniform3f(location, value.x, value.y, value.z);
+}
+
+void Shader::setVector4f(int location, const glm::vec4 &value) const {
+    glUniform4f(location, value.x, value.y, value.z, value.w);
+}
+
+void Shader::setMatrix4(int location, const glm::mat4 &matrix) const {
+    glUniformMatrix4fv(location, 1, false, glm::value_ptr(matrix));
 }
 
 
@@ -5,8 +5,17 @@
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 using std::string, std::ifstream, std::stringstream, std::cout, std::endl;
 
+// From KHR_parallel_shader_compile, in case the GL loader was generated without it
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
 /// @brief General purpose shader object.
 /// @details Compiles from file, generates compile/link-time error messages and hosts several utility functions for easy management.
 class Shader {
@@ -29,6 +38,36 @@ class Shader {
         /// @param geometrySource the source code for the geometry shader (optional)
         void compile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr); // note: geometry source code is optional
 
+        /// @brief Starts compiling and linking the shader without waiting for the driver
+        /// @details Nothing is checked until finishCompile(), so the driver can work on several programs at once
+        /// (on its own threads with KHR_parallel_shader_compile). The shader can't be used until then.
+        /// @param vertexSource the source code for the vertex shader
+        /// @param fragmentSource the source code for the fragment shader
+        /// @param geometrySource the source code for the geometry shader (optional)
+        void beginCompile(const char *vertexSource, const char *fragmentSource, const char *geometrySource = nullptr);
+
+        /// @brief Returns true if finishCompile() wouldn't wait for the driver
+        /// @details Only the driver knows, through KHR_parallel_shader_compile. Without it, this always returns true,
+        /// and finishCompile() waits.
+        bool isCompileDone() const;
+
+        /// @brief Checks the results of beginCompile(), prints the error logs and prepares the program for use
+        void finishCompile();
+
+        /// @brief Creates the program from a binary saved with glGetProgramBinary (see ProgramCache)
+        /// @param format the binary format glGetProgramBinary returned
+        /// @param binary the program binary
+        /// @param length the size of the binary in bytes
+        /// @return false if the driver rejected the binary (no program is kept)
+        bool loadBinary(GLenum format, const void *binary, GLsizei length);
+
+        /// @brief Returns the location handle of a uniform
+        /// @details Locations are resolved once when the program is linked, so this never calls into the driver.
+        /// Resolve handles once (e.g. in a constructor) and pass them to the by-handle setters below.
+        /// @param name name of the uniform
+        /// @return the location of the uniform, or -1 if the program has no active uniform with that name
+        int getUniformLocation(const char *name) const;
+
         // ------------------------------------------------------------------------
         // utility functions
         // ------------------------------------------------------------------------
@@ -45,6 +84,11 @@ class Shader {
         /// @param useShader boolean to indicate whether to use this shader
         void setInteger(const char *name, int value) const;
 
+        /// @brief set a uniform unsigned integer in the shader
+        /// @param name name of the uniform
+        /// @param value unsigned integer value to set
+        void setUnsignedInteger(const char *name, unsigned int value) const;
+
         /// @brief set a uniform vector of two floats in the shader
         /// @param name name of the uniform
         /// @param value x and y values to set as a glm::vec2
@@ -87,7 +131,62 @@ class Shader {
         /// @param useShader boolean to indicate whether to use this shader
         void setMatrix4(const char *name, const glm::mat4 &matrix) const;
 
+        // ------------------------------------------------------------------------
+        // by-handle utility functions (location from getUniformLocation())
+        // ------------------------------------------------------------------------
+
+        /// @brief set a uniform float in the shader
+        /// @param location location handle of the uniform
+        /// @param value float value to set
+        void setFloat(int location, float value) const;
+
+        /// @brief set a uniform integer in the shader
+        /// @param location location handle of the uniform
+        /// @param value integer value to set
+        void setInteger(int location, int value) const;
+
+        /// @brief set a uniform unsigned integer in the shader
+        /// @param location location handle of the uniform
+        /// @param value unsigned integer value to set
+        void setUnsignedInteger(int location, unsigned int value) const;
+
+        /// @brief set a uniform vector of two floats in the shader
+        /// @param location location handle of the uniform
+        /// @param value glm::vec2 values to set
+        void setVector2f(int location, const glm::vec2 &value) const;
+
+        /// @brief set a uniform vector of three floats in the shader
+        /// @param location location handle of the uniform
+        /// @param value glm::vec3 values to set
+        void setVector3f(int location, const glm::vec3 &value) const;
+
+        /// @brief set a uniform vector of four floats in the shader
+        /// @param location location handle of the uniform
+        /// @param value glm::vec4 values to set
+        void setVector4f(int location, const glm::vec4 &value) const;
+
+        /// @brief set a uniform matrix of four floats in the shader
+        /// @param location location handle of the uniform
+        /// @param matrix glm::mat4 values to set
+        void setMatrix4(int location, const glm::mat4 &matrix) const;
+
     private:
+        /// @brief Locations of every active uniform, keyed by name
+        /// @details Filled in by cacheUniformLocations() right after the program is linked.
+        std::unordered_map<string, int> uniformLocations;
+
+        /// @brief Queries every active uniform of the linked program and stores its location
+        void cacheUniformLocations();
+
+        /// @brief Binds the program's FrameData block, if it uses it, to the shared per-frame uniform buffer (see FrameUniforms)
+        void bindUniformBlocks();
+
+        /// @brief Shader objects (and their types, for the error logs) started by beginCompile() and not yet checked
+        std::vector<std::pair<unsigned int, string>> pendingStages;
+
+        /// @brief Returns true if the driver offers KHR (or ARB) _parallel_shader_compile (checked once)
+        static bool hasParallelCompile();
+
         /// @brief Checks if compilation or linking failed and if so, print the error logs
         /// @param object the shader object to check
         /// @param type the type of shader object (vertex, fragment, geometry)
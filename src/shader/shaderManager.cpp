@@ -1,6 +1,6 @@
 #include "shaderManager.h"
-#include <fstream>
-#include <sstream>
+#include "../renderer/glState.h"
+#include "../util/resources.h"
 
 
 ShaderManager::~ShaderManager() {
@@ -19,45 +19,73 @@ void ShaderManager::clear() {
     // delete all shaders: "iter" here is const std::pair<std::string, Shader>&, so we need to use
     // "iter.second" to get the Shader, and delete the program by ID
     for (const auto &iter: shaders)
-        glDeleteProgram(iter.second.ID);
+        GLState::deleteProgram(iter.second.ID);
+}
+
+ShaderManager::ShaderSources ShaderManager::readSources(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile) {
+    // retrieve the vertex/fragment source code from the resources embedded in the executable
+    ShaderSources sources;
+    sources.hasGeometry = gShaderFile != nullptr;
+    std::string_view vertex = resources::find(vShaderFile);
+    std::string_view fragment = resources::find(fShaderFile);
+    // if geometry shader path is present, also load a geometry shader
+    std::string_view geometry = sources.hasGeometry ? resources::find(gShaderFile) : std::string_view();
+    if (!vertex.data() || !fragment.data() || (sources.hasGeometry && !geometry.data()))
+        std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
+    sources.vertex = vertex;
+    sources.fragment = fragment;
+    sources.geometry = geometry;
+    return sources;
 }
 
 Shader ShaderManager::loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile) {
     // 1. retrieve the vertex/fragment source code from filePath
-    std::string vertexCode;
-    std::string fragmentCode;
-    std::string geometryCode;
-    try {
-        // open files
-        std::ifstream vertexShaderFile(vShaderFile);
-        std::ifstream fragmentShaderFile(fShaderFile);
-        std::stringstream vShaderStream, fShaderStream;
-        // read file's buffer contents into streams
-        vShaderStream << vertexShaderFile.rdbuf();
-        fShaderStream << fragmentShaderFile.rdbuf();
-        // close file handlers
-        vertexShaderFile.close();
-        fragmentShaderFile.close();
-        // convert stream into string
-        vertexCode = vShaderStream.str();
-        fragmentCode = fShaderStream.str();
-        // if geometry shader path is present, also load a geometry shader
-        if (gShaderFile != nullptr) {
-            std::ifstream geometryShaderFile(gShaderFile);
-            std::stringstream gShaderStream;
-            gShaderStream << geometryShaderFile.rdbuf();
-            geometryShaderFile.close();
-            geometryCode = gShaderStream.str();
-        }
-    }
-    catch (std::exception &e) {
-        std::cout << "ERROR::SHADER: Failed to read shader files" << std::endl;
-    }
-    const char *vShaderCode = vertexCode.c_str();
-    const char *fShaderCode = fragmentCode.c_str();
-    const char *gShaderCode = geometryCode.c_str();
-    // 2. now create shader object from source code
+    ShaderSources sources = readSources(vShaderFile, fShaderFile, gShaderFile);
+    const char *vShaderCode = sources.vertex.c_str();
+    const char *fShaderCode = sources.fragment.c_str();
+    const char *gShaderCode = sources.hasGeometry ? sources.geometry.c_str() : nullptr;
+    // 2. now create shader object, from the binary cached by an earlier launch if the driver takes it
     Shader shader;
-    shader.compile(vShaderCode, fShaderCode, gShaderFile != nullptr ? gShaderCode : nullptr);
+    uint64_t key = programCache.makeKey(vShaderCode, fShaderCode, gShaderCode);
+    if (programCache.load(shader, key))
+        return shader;
+    // 3. or else from source code
+    shader.compile(vShaderCode, fShaderCode, gShaderCode);
+    programCache.store(shader, key);
     return shader;
-}
\ No newline at end of file
+}
+
+void ShaderManager::queueShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name) {
+    ShaderSources sources = readSources(vShaderFile, fShaderFile, gShaderFile);
+    const char *gShaderCode = sources.hasGeometry ? sources.geometry.c_str() : nullptr;
+
+    // A cached binary links right away, so only programs built from source are left pending
+    Shader &shader = shaders[name];
+    uint64_t key = programCache.makeKey(sources.vertex.c_str(), sources.fragment.c_str(), gShaderCode);
+    if (programCache.load(shader, key))
+        return;
+    shader.beginCompile(sources.vertex.c_str(), sources.fragment.c_str(), gShaderCode);
+    pending.push_back({name, key});
+    queued++;
+}
+
+bool ShaderManager::finishShaders(bool wait) {
+    // Only ask for results the driver already has, so nothing here waits on a compile (unless told to)
+    for (size_t i = 0; i < pending.size();) {
+        Shader &shader = shaders[pending[i].name];
+        if (wait || shader.isCompileDone()) {
+            shader.finishCompile();
+            programCache.store(shader, pending[i].key);
+            pending.erase(pending.begin() + i);
+        } else {
+            ++i;
+        }
+    }
+    if (pending.empty())
+        queued = 0;
+    return pending.empty();
+}
+
+float ShaderManager::getProgress() const {
+    return queued == 0 ? 1.0f : float(queued - pending.size()) / queued;
+}
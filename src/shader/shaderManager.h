@@ -2,9 +2,11 @@
 #define GRAPHICS_SHADERMANAGER_H
 
 #include "shader.h"
+#include "programCache.h"
 
 #include <map>
 #include <iostream>
+#include <vector>
 
 class ShaderManager {
 public:
@@ -16,13 +18,32 @@ public:
 
 
     /// @brief Calls loadShaderFromFile() and stores the shader in the shaders map
-    /// @param vShaderFile The vertex shader file
-    /// @param fShaderFile The fragment shader file
-    /// @param gShaderFile The geometry shader file (optional)
+    /// @details Shaders are embedded resources, named by their path inside res/ (e.g. "shaders/shape.vert").
+    /// @param vShaderFile The vertex shader resource
+    /// @param fShaderFile The fragment shader resource
+    /// @param gShaderFile The geometry shader resource (optional)
     /// @param name Name used for the shader in the shaders map
     /// @return The shader that was loaded
     Shader loadShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
 
+    /// @brief Starts loading a shader without waiting for the driver to compile it
+    /// @details The shader is put in the shaders map right away (from the program cache if it has it), but it
+    /// can't be used, or its uniforms looked up, until finishShaders() has returned true.
+    /// Queue every shader first, so the driver can compile them all at once.
+    /// @param vShaderFile The vertex shader resource
+    /// @param fShaderFile The fragment shader resource
+    /// @param gShaderFile The geometry shader resource (optional)
+    /// @param name Name used for the shader in the shaders map
+    void queueShader(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile, std::string name);
+
+    /// @brief Finishes the queued shaders the driver is done with (and caches their binaries)
+    /// @param wait True to block until every queued shader is finished
+    /// @return True if no shader is left pending
+    bool finishShaders(bool wait = false);
+
+    /// @brief Returns the fraction of the queued shaders that are finished (1 if none are pending)
+    float getProgress() const;
+
     /// @brief Returns a reference to the shader with the given name in the shaders map
     /// @param name The name of the shader
     /// @return The shader with the given name
@@ -35,11 +56,37 @@ private:
     /// @brief A map of shaders, with the key being the name of the shader
     std::map<std::string, Shader> shaders;
 
+    /// @brief Linked program binaries from earlier launches
+    ProgramCache programCache;
+
+    /// @brief A queued shader that is still compiling
+    struct PendingShader {
+        std::string name;
+        uint64_t key;
+    };
+
+    /// @brief Shaders started by queueShader() and not yet finished
+    std::vector<PendingShader> pending;
+
+    /// @brief Number of shaders queued since the queue was last empty (for getProgress())
+    size_t queued = 0;
+
+    /// @brief The source code of a shader's stages
+    struct ShaderSources {
+        std::string vertex, fragment, geometry;
+        bool hasGeometry;
+    };
+
+    /// @brief Reads the source code of a shader's stages from their resources (see resources::find())
+    static ShaderSources readSources(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile);
+
      /// @brief Loads and compiles a shader from a file
-     /// @details This function is private because we only want to load shaders from within this class
-     /// @param vShaderFile The vertex shader file
-     /// @param fShaderFile The fragment shader file
-     /// @param gShaderFile The geometry shader file (optional)
+     /// @details This function is private because we only want to load shaders from within this class.
+     /// The program is loaded from the program cache when it has a binary for these sources and this driver;
+     /// otherwise it is compiled and linked, and its binary is cached for the next launch.
+     /// @param vShaderFile The vertex shader resource
+     /// @param fShaderFile The fragment shader resource
+     /// @param gShaderFile The geometry shader resource (optional)
      /// @return The shader that was loaded
     Shader loadShaderFromFile(const char *vShaderFile, const char *fShaderFile, const char *gShaderFile=nullptr);};
 
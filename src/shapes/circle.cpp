@@ -1,79 +1,47 @@
-//#include "circle.h"
-//#include "rect.h"
-//
-//
-//Circle::~Circle() {
-//    glDeleteVertexArrays(1, &VAO);
-//    glDeleteBuffers(1, &VBO);
-//}
-//
-//void Circle::setUniforms() const {
-//    Shape::setUniforms(); // Sets model and shapeColor uniforms
-//    shader.setFloat("radius", radius);
-//    shader.setVector2f("center", pos.x, pos.y);
-//}
-//
-//void Circle::draw() const {
-//    glBindVertexArray(VAO);
-//    glDrawArrays(GL_TRIANGLE_FAN, 0, segments + 2); // +2 for center and last vertex
-//    glBindVertexArray(0);
-//}
-//
-//void Circle::initVectors() {
-//    // Center of circle
-//    vertices.push_back(0.0f);
-//    vertices.push_back(0.0f);
-//    for (int i = 0; i <= segments; ++i) {
-//        float theta = 2.0f * 3.1415926f * float(i) / float(segments);
-//        vertices.push_back(radius * cosf(theta)); // x = r*cos(theta)
-//        vertices.push_back(radius * sinf(theta)); // y = r*sin(theta)
-//    }
-//}
-//
-//void Circle::setRadius(float radius) {
-//    this->radius = radius;
-//    size = vec2(radius * 2, radius * 2);
-//}
-//
-//float Circle::getRadius() const { return radius; }
-//
-//float Circle::getLeft() const   { return pos.x - radius; }
-//float Circle::getRight() const  { return pos.x + radius; }
-//float Circle::getTop() const    { return pos.y + radius; }
-//float Circle::getBottom() const { return pos.y - radius; }
-//
-//bool Circle::isOverlapping(const Circle &c) const {
-//    // Check if the distance between the centers of the circles is less than the sum of their radii
-//    // distance = sqrt((x2 - x1)^2 + (y2 - y1)^2)
-//    float dist = distance(pos, c.getPos());
-//    float radiusSum = radius + c.getRadius();
-//    return dist < radiusSum;
-//}
-//
-//void Circle::bounce(Circle &other) {
-//    glm::vec2 delta = other.getPos() - this->getPos();
-//    float distance = glm::length(delta);
-//    float overlap = 0.5f * (this->getRadius() + other.getRadius() - distance);
-//
-//    // Check if circles are overlapping
-//    if (overlap > 0) {
-//        // Adjust positions based on radius (as a proxy for mass)
-//        float thisMass = this->getRadius() * this->getRadius() * M_PI;
-//        float otherMass = other.getRadius() * other.getRadius() * M_PI;
-//        float totalMass = thisMass + otherMass;
-//
-//        this->setPos(this->getPos() - overlap * (thisMass / totalMass) * delta / distance);
-//        other.setPos(other.getPos() + overlap * (otherMass / totalMass) * delta / distance);
-//
-//        // Velocity calculations for elastic collision
-//        glm::vec2 thisVelocity = this->getVelocity();
-//        glm::vec2 otherVelocity = other.getVelocity();
-//        glm::vec2 velocityDifference = thisVelocity - otherVelocity;
-//
-//        float dotProduct = glm::dot(velocityDifference, delta) / (distance * distance);
-//        glm::vec2 collisionNormal = dotProduct * delta;
-//
-//        this->setVelocity(thisVelocity - (2 * otherMass / totalMass) * collisionNormal);
-//        other.setVelocity(otherVelocity + (2 * thisMass / totalMass) * collisionNormal);
-//    }
-//}
\ No newline at end of file
+#include "circle.h"
+#include "rect.h"
+
+Circle::Circle(Shader & shader, vec2 pos, float radius, struct color color)
+    : Shape(shader, pos, vec2(radius * 2, radius * 2), color, GeometryCache::get(ShapeKind::Rect)) {}
+
+Circle::Circle(Circle const& other) : Shape(other) {}
+
+float Circle::getRadius() const { return size.x / 2; }
+
+void Circle::setRadius(float radius) {
+    setSize(vec2(radius * 2, radius * 2));
+}
+
+// Overridden Getters from Shape
+float Circle::getLeft() const   { return pos.x - getRadius(); }
+float Circle::getRight() const  { return pos.x + getRadius(); }
+float Circle::getTop() const    { return pos.y + getRadius(); }
+float Circle::getBottom() const { return pos.y - getRadius(); }
+
+bool Circle::contains(vec2 point) const {
+    // Compare squared distances so we don't need a sqrt
+    vec2 delta = point - pos;
+    return delta.x * delta.x + delta.y * delta.y < getRadius() * getRadius();
+}
+
+bool Circle::isOverlapping(const Circle &other) const {
+    // The circles overlap when their centers are closer than the sum of their radii
+    vec2 delta = other.getPos() - pos;
+    float radiusSum = getRadius() + other.getRadius();
+    return delta.x * delta.x + delta.y * delta.y < radiusSum * radiusSum;
+}
+
+bool Circle::isOverlapping(const Shape &other) const {
+    const Circle* otherCircle = dynamic_cast<const Circle*>(&other);
+    if (otherCircle) {
+        return isOverlapping(*otherCircle);
+    }
+    const Rect* otherRect = dynamic_cast<const Rect*>(&other);
+    if (otherRect) {
+        // Find the point of the rect closest to our center, then check if it is inside the circle
+        vec2 closest(glm::clamp(pos.x, otherRect->getLeft(), otherRect->getRight()),
+                     glm::clamp(pos.y, otherRect->getBottom(), otherRect->getTop()));
+        return contains(closest);
+    }
+    return false;
+}
@@ -0,0 +1,66 @@
+#include "geometry.h"
+#include "../renderer/glState.h"
+
+std::map<ShapeKind, Mesh> GeometryCache::meshes;
+
+const Mesh &GeometryCache::get(ShapeKind kind) {
+    auto iter = meshes.find(kind);
+    if (iter != meshes.end())
+        return iter->second;
+
+    Mesh mesh{};
+    switch (kind) {
+        case ShapeKind::Rect:
+            mesh = create({
+                -0.5f, 0.5f,   // Top left
+                0.5f, 0.5f,    // Top right
+                -0.5f, -0.5f,  // Bottom left
+                0.5f, -0.5f    // Bottom right
+            }, {
+                0, 1, 2, // First triangle
+                1, 2, 3  // Second triangle
+            });
+            break;
+        case ShapeKind::Triangle:
+            mesh = create({
+                -0.5f, -0.5f,  // Bottom left
+                0.5f, -0.5f,   // Bottom right
+                0.0f, 0.5f     // Top
+            }, {
+                0, 1, 2
+            });
+            break;
+    }
+    return meshes[kind] = mesh;
+}
+
+void GeometryCache::clear() {
+    for (const auto &iter : meshes) {
+        GLState::deleteVertexArray(iter.second.VAO);
+        GLState::deleteBuffer(iter.second.VBO);
+        GLState::deleteBuffer(iter.second.EBO);
+    }
+    meshes.clear();
+}
+
+Mesh GeometryCache::create(const vector<float> &vertices, const vector<unsigned int> &indices) {
+    Mesh mesh{};
+    mesh.indexCount = static_cast<GLsizei>(indices.size());
+
+    glGenVertexArrays(1, &mesh.VAO);
+    GLState::bindVertexArray(mesh.VAO);
+
+    // Generate VBO, bind it to VAO, and copy vertices data into it
+    glGenBuffers(1, &mesh.VBO);
+    GLState::bindBuffer(GL_ARRAY_BUFFER, mesh.VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+
+    // Set the vertex attribute pointers (2 floats per vertex (x, y))
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glGenBuffers(1, &mesh.EBO);
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    return mesh;
+}
@@ -0,0 +1,50 @@
+#ifndef GRAPHICS_GEOMETRY_H
+#define GRAPHICS_GEOMETRY_H
+
+#include <map>
+#include <vector>
+#include <glad/glad.h>
+
+using std::vector;
+
+/// @brief The kinds of unit meshes shapes can be drawn with.
+enum class ShapeKind {
+    Rect,
+    Triangle
+};
+
+/// @brief An immutable mesh living on the GPU.
+/// @details VAO has the VBO bound at attribute 0 (2 floats per vertex) and the EBO attached.
+struct Mesh {
+    unsigned int VAO, VBO, EBO;
+    GLsizei indexCount;
+};
+
+/// @brief Cache of the unit meshes shared by every shape of the same kind.
+/// @details Shapes only store a position, size and color. The unit mesh is placed with a vec4 transform
+/// (xy = offset, zw = scale), set as the "transform" uniform or the per-instance attribute of instanced draws,
+/// so every Rect can share one quad and every Triangle can share one triangle.
+/// Meshes are created on first use and live until clear() is called.
+class GeometryCache {
+    public:
+        /// @brief Returns the shared mesh for a kind of shape, creating it on first use
+        /// @param kind The kind of shape
+        /// @return The shared mesh
+        static const Mesh& get(ShapeKind kind);
+
+        /// @brief Deletes all cached meshes
+        /// @details Must be called while the OpenGL context is still current.
+        static void clear();
+
+    private:
+        /// @brief The cached meshes, keyed by shape kind
+        static std::map<ShapeKind, Mesh> meshes;
+
+        /// @brief Uploads vertices and indices into a new VAO/VBO/EBO
+        /// @param vertices 2D vertex positions (x, y pairs)
+        /// @param indices Triangle indices into vertices
+        /// @return The new mesh
+        static Mesh create(const vector<float>& vertices, const vector<unsigned int>& indices);
+};
+
+#endif //GRAPHICS_GEOMETRY_H
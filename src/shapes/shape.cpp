@@ -1,54 +1,49 @@
 #include "shape.h"
+#include "../renderer/glState.h"
 
-Shape::Shape(Shader &shader, glm::vec2 pos, glm::vec2 size, struct color color) :
-    shader(shader), pos(pos), size(size), color(color) {}
+Shape::Shape(Shader &shader, glm::vec2 pos, glm::vec2 size, struct color color, const Mesh& mesh) :
+    shader(shader), pos(pos), size(size), color(color),
+    transformLocation(shader.getUniformLocation("transform")), colorLocation(shader.getUniformLocation("packedColor")),
+    mesh(&mesh) {}
 
 Shape::Shape(Shape const& other) :
-    shader(other.shader), pos(other.pos), size(other.size), color(other.color) {}
+    shader(other.shader), pos(other.pos), size(other.size), color(other.color),
+    transformLocation(other.transformLocation), colorLocation(other.colorLocation), mesh(other.mesh) {}
 
-// Initialize VAO
-unsigned int Shape::initVAO() {
-    glGenVertexArrays(1, &VAO); // Generate VAO
-    glBindVertexArray(VAO); // Bind VAO
-    return VAO;
-}
+void Shape::setUniforms() const {
+    // If you want to use a custom shader, you have to set it and call it's Use() function here.
+    // Since we are using the same shader for all shapes, we can just set it once in the constructor.
+    //this->shader.use();
 
-// Initialize VBO
-void Shape::initVBO() {
-    // Generate VBO, bind it to VAO, and copy vertices data into it
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    // The vertex shader places the unit mesh itself: position is the center and size scales it.
+    // This is 4 floats instead of a 16 float model matrix, and needs no matrix math on the CPU.
+    this->shader.setVector4f(transformLocation, vec4(pos.x, pos.y, size.x, size.y));
+    // The color is packed into one RGBA8 integer
+    this->shader.setUnsignedInteger(colorLocation, color.packed());
+}
 
-    // Set the vertex attribute pointers (2 floats per vertex (x, y))
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0); // Enable the vertex attribute at location 0
-    glBindBuffer(GL_ARRAY_BUFFER, 0); // Unbind VBO
+void Shape::draw() const {
+    // Consecutive shapes of the same kind share the VAO, so this bind is usually skipped
+    GLState::bindVertexArray(mesh->VAO);
+    glDrawElements(GL_TRIANGLES, mesh->indexCount, GL_UNSIGNED_INT, 0);
 }
 
-// Initialize EBO
-void Shape::initEBO() {
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(float), indices.data(), GL_STATIC_DRAW);
-    // Don't unbind EBO because it's bound to VAO
+// Damage tracking
+vec4 Shape::getBounds() const {
+    return vec4(getLeft(), getBottom(), getRight(), getTop());
 }
 
-void Shape::setUniforms() const {
-    // If you want to use a custom shader, you have to set it and call it's Use() function here.
-    // Since we are using the same shader for all shapes, we can just set it once in the constructor.
-    //this->shader.use();
+vec4 Shape::getDrawnBounds() const { return drawnBounds; }
+bool Shape::wasDrawn() const       { return drawn; }
 
-    // Define the model matrix for the shape as a 4x4 identity matrix
-    mat4 model = mat4(1.0f);
-    // The model matrix is used to transform the vertices of the shape in relation to the world space.
-    model = translate(model, vec3(pos, 1.0f));
-    // The size of the shape is scaled by the model matrix to make the shape larger or smaller.
-    model = scale(model, vec3(size, 1.0f));
+bool Shape::isDirty() const {
+    return !drawn || getBounds() != drawnBounds || color.packed() != drawnColor;
+}
 
-    // Set the model matrix and color uniform variables in the shader
-    this->shader.setMatrix4("model", model);
-    this->shader.setVector4f("shapeColor", color.vec);
+void Shape::markDrawn() {
+    drawnBounds = getBounds();
+    drawnColor = color.packed();
+    drawn = true;
 }
 
 // Setters
@@ -88,5 +83,7 @@ float Shape::getRed() const     { return color.red; }
 float Shape::getGreen() const   { return color.green; }
 float Shape::getBlue() const    { return color.blue; }
 float Shape::getOpacity() const { return color.alpha; }
+const Shader& Shape::getShader() const { return shader; }
+const Mesh& Shape::getMesh() const     { return *mesh; }
 
 void Shape::update(float deltaTime) {}
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "glm/glm.hpp"
 #include <vector>
 #include "../shader/shader.h"
+#include "geometry.h"
 
 using std::vector, glm::vec2, glm::vec3, glm::vec4, glm::mat4, glm::translate, glm::scale;
 
@@ -21,6 +22,13 @@ struct color {
     color(float r, float g, float b) : vec(r, g, b, 1.0f) {}
     color(float r, float g, float b, float a) : vec(r, g, b, a) {}
 
+    /// @brief Packs the color into RGBA8 (red in the lowest byte), as the shaders expect it
+    static unsigned int pack(const glm::vec4 &c) {
+        auto channel = [](float v) { return static_cast<unsigned int>(glm::clamp(v, 0.0f, 1.0f) * 255.0f + 0.5f); };
+        return channel(c.x) | (channel(c.y) << 8) | (channel(c.z) << 16) | (channel(c.w) << 24);
+    }
+    unsigned int packed() const { return pack(vec); }
+
     /* Overloaded Operator */
     friend std::ostream &operator<<(std::ostream &outs, const color &c) {
         outs << "Red: " << c.red << ", Green: " << c.green << ", Blue: " << c.blue << ", Alpha: " << c.alpha;
@@ -36,7 +44,8 @@ class Shape {
         /// @param pos The position of the shape
         /// @param size The size of the shape
         /// @param color The color of the shape
-        Shape(Shader& shader, vec2 pos, glm::vec2 size, color color);
+        /// @param mesh The shared unit mesh to draw the shape with (see GeometryCache)
+        Shape(Shader& shader, vec2 pos, glm::vec2 size, color color, const Mesh& mesh);
 
         /// @brief Copy constructor for Shape
         Shape(Shape const& other);
@@ -44,23 +53,6 @@ class Shape {
         /// @brief Destroy the Shape object
         virtual ~Shape() = default;
 
-        // --------------------------------------------------------
-        // Initialization functions
-        // --------------------------------------------------------
-
-        /// @brief Initializes the VAO.
-        /// @details This function is called in the derived classes' constructor.
-        unsigned int initVAO();
-
-        /// @brief Initializes the VBO.
-        /// @details This function is called in the derived classes' constructor.
-        void initVBO();
-
-        /// @brief Initializes the EBO.
-        /// @details This function is called in the derived classes' constructor.
-        /// @details If function has no indices, pass nullptr for indices and 0 for indexCount.
-        void initEBO();
-
         // --------------------------------------------------------
         // Getters
         // --------------------------------------------------------
@@ -86,6 +78,10 @@ class Shape {
         int getSizeX() const;
         int getSizeY() const;
 
+        // Rendering Functions
+        const Shader& getShader() const;
+        const Mesh& getMesh() const;
+
         // Velocity Functions
         vec2 getVelocity() const;
         void setVelocity(vec2 velocity);
@@ -138,8 +134,27 @@ class Shape {
         /// @brief Sets the uniform variables from members, and calls the virtual draw function
         virtual void setUniforms() const;
 
-        /// @brief Pure virtual function to draw the shape.
-        virtual void draw() const = 0;
+        /// @brief Binds the shared mesh and draws it.
+        virtual void draw() const;
+
+        // --------------------------------------------------------
+        // Damage tracking (see DamageTracker)
+        // --------------------------------------------------------
+
+        /// @brief Returns the bounds of the shape as (left, bottom, right, top)
+        vec4 getBounds() const;
+
+        /// @brief Returns the bounds the shape had the last time markDrawn() was called
+        vec4 getDrawnBounds() const;
+
+        /// @brief Returns true if markDrawn() was ever called
+        bool wasDrawn() const;
+
+        /// @brief Returns true if the shape moved, resized or changed color since markDrawn() was last called
+        bool isDirty() const;
+
+        /// @brief Records the current bounds and color as what is on screen
+        void markDrawn();
 
 protected:
         /// @brief Shader used to draw all abstract shapes.
@@ -155,17 +170,17 @@ protected:
         /// @brief The VAO of the shape
         color color;
 
-        /// @brief The Vertex Array Object, Vertex Buffer Object, and Element Buffer Object of the shape.
-        unsigned int VAO, VBO, EBO;
-
-        /// @brief The vertices of the shape
-        vector<float> vertices;
-
-        /// @brief The indices of the shape
-        vector<unsigned int> indices;
+        /// @brief Location handles of the "transform" and "packedColor" uniforms, resolved once at construction.
+        int transformLocation, colorLocation;
 
-        virtual void initVectors() = 0;
+        /// @brief The unit mesh shared by every shape of this kind.
+        /// @details Owned by GeometryCache, so shapes never create or delete GL objects themselves.
+        const Mesh* mesh;
 
+        /// @brief Bounds and packed color of the shape as it was last drawn (see markDrawn()).
+        vec4 drawnBounds = vec4(0.0f);
+        unsigned int drawnColor = 0;
+        bool drawn = false;
 };
 
 #endif //GRAPHICS_SHAPE_H
@@ -0,0 +1,25 @@
+#ifndef GRAPHICS_HASH_H
+#define GRAPHICS_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hash {
+    /// @brief Starting value of an FNV-1a hash
+    const uint64_t FNV_OFFSET = 14695981039346656037ull;
+
+    /// @brief Continues a 64-bit FNV-1a hash over size bytes of data
+    /// @details Used to tell whether a cached file (baked font, program binary) was built from the same inputs.
+    /// Not meant to resist deliberate collisions.
+    inline uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+        const uint64_t FNV_PRIME = 1099511628211ull;
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+}
+
+#endif //GRAPHICS_HASH_H
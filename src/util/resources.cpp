@@ -0,0 +1,46 @@
+#include "resources.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace {
+    /// @brief Files read from the override directory, kept so the views find() returned stay valid
+    std::map<std::string, std::string, std::less<>> loaded;
+    std::mutex loadedMutex;
+
+    /// @brief Returns a resource from the override directory, or an empty view if it isn't there (or none is set)
+    std::string_view findOnDisk(std::string_view name) {
+        static const char *directory = std::getenv(resources::OVERRIDE_VARIABLE);
+        if (!directory)
+            return {};
+
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        auto iter = loaded.find(name);
+        if (iter == loaded.end()) {
+            std::ifstream file(std::string(directory) + "/" + std::string(name), std::ios::binary);
+            if (!file)
+                return {};
+            std::string contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            iter = loaded.emplace(std::string(name), std::move(contents)).first;
+        }
+        // c_str(), so the contents are followed by a 0 byte like the embedded ones
+        return std::string_view(iter->second.c_str(), iter->second.size());
+    }
+}
+
+std::string_view resources::find(std::string_view name) {
+    std::string_view file = findOnDisk(name);
+    if (file.data())
+        return file;
+
+    for (size_t i = 0; i < detail::ENTRY_COUNT; ++i) {
+        const detail::Entry &entry = detail::ENTRIES[i];
+        if (name == entry.name)
+            return std::string_view(reinterpret_cast<const char*>(entry.data), entry.size);
+    }
+    return {};
+}
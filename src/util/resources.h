@@ -0,0 +1,38 @@
+#ifndef GRAPHICS_RESOURCES_H
+#define GRAPHICS_RESOURCES_H
+
+#include <cstddef>
+#include <string_view>
+
+/// @brief Files compiled into the executable, so startup reads no shaders or fonts from disk.
+/// @details The embedResources build step (tools/embedResources.cmake) turns every shader and font in res/, and the
+/// baked font atlas, into constexpr byte arrays. They are looked up by their path inside res/ (e.g. "shaders/shape.vert"),
+/// or inside the build directory for the baked atlas (e.g. "fonts/MxPlus_IBM_BIOS.24.sdf.atlas").
+///
+/// While working on the resources, set GRAPHICS_RESOURCE_DIR to a directory (e.g. the repository's res/) to read
+/// them from there instead, without rebuilding. A resource that isn't in that directory still comes from the executable.
+namespace resources {
+    /// @brief Name of the environment variable that points find() at a resource directory on disk
+    constexpr const char* OVERRIDE_VARIABLE = "GRAPHICS_RESOURCE_DIR";
+
+    /// @brief Returns the contents of a resource
+    /// @details The bytes stay valid (and are followed by a 0 byte) until the program exits.
+    /// @param name Path of the resource inside res/
+    /// @return The contents, or an empty view (with a null data()) if there is no such resource
+    std::string_view find(std::string_view name);
+
+    namespace detail {
+        /// @brief One embedded resource
+        struct Entry {
+            const char* name;
+            const unsigned char* data;
+            size_t size;
+        };
+
+        /// @brief Every embedded resource (defined in the generated embeddedResources.cpp)
+        extern const Entry ENTRIES[];
+        extern const size_t ENTRY_COUNT;
+    }
+}
+
+#endif //GRAPHICS_RESOURCES_H
@@ -0,0 +1,56 @@
+#ifndef GRAPHICS_UTF8_H
+#define GRAPHICS_UTF8_H
+
+#include <cstddef>
+#include <string_view>
+
+namespace utf8 {
+    /// @brief Code point returned for malformed input (U+FFFD REPLACEMENT CHARACTER)
+    const char32_t REPLACEMENT = 0xFFFD;
+
+    /// @brief Decodes the code point starting at text[i] and moves i past it
+    /// @details Invalid, overlong, truncated or surrogate sequences decode to REPLACEMENT and skip a single byte,
+    /// so decoding always makes progress and resynchronizes on the next valid sequence.
+    inline char32_t next(std::string_view text, size_t& i) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        if (lead < 0x80) {
+            i++;
+            return lead;
+        }
+
+        size_t length;
+        char32_t code, minimum;
+        if ((lead & 0xE0) == 0xC0) {
+            length = 2; code = lead & 0x1F; minimum = 0x80;
+        } else if ((lead & 0xF0) == 0xE0) {
+            length = 3; code = lead & 0x0F; minimum = 0x800;
+        } else if ((lead & 0xF8) == 0xF0) {
+            length = 4; code = lead & 0x07; minimum = 0x10000;
+        } else {
+            i++;
+            return REPLACEMENT;
+        }
+        if (i + length > text.size()) {
+            i++;
+            return REPLACEMENT;
+        }
+
+        for (size_t k = 1; k < length; k++) {
+            unsigned char continuation = static_cast<unsigned char>(text[i + k]);
+            if ((continuation & 0xC0) != 0x80) {
+                i++;
+                return REPLACEMENT;
+            }
+            code = (code << 6) | (continuation & 0x3F);
+        }
+        if (code < minimum || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF)) {
+            i++;
+            return REPLACEMENT;
+        }
+
+        i += length;
+        return code;
+    }
+}
+
+#endif //GRAPHICS_UTF8_H
@@ -0,0 +1,32 @@
+# Compiles resource files into a C++ source of constexpr byte arrays, looked up through resources::find()
+# (see src/util/resources.h). Run by the embedResources target as
+#   cmake -DOUTPUT=<file.cpp> -DRESOURCES=<name>=<path>;... -DHEADER=<resources.h> -P embedResources.cmake
+# where <name> is what the resource is looked up as (e.g. shaders/shape.vert).
+
+set(DEFINITIONS "")
+set(ENTRIES "")
+set(INDEX 0)
+string(REPEAT "0x..," 16 ROW)
+foreach(RESOURCE ${RESOURCES})
+    string(FIND "${RESOURCE}" "=" SPLIT)
+    string(SUBSTRING "${RESOURCE}" 0 ${SPLIT} NAME)
+    math(EXPR SPLIT "${SPLIT} + 1")
+    string(SUBSTRING "${RESOURCE}" ${SPLIT} -1 FILE_PATH)
+
+    # One byte per 0x.., 16 to a line; a terminating 0 keeps empty files valid arrays and text usable as C strings
+    file(READ "${FILE_PATH}" HEX HEX)
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," BYTES "${HEX}")
+    string(REGEX REPLACE "(${ROW})" "\\1\n        " BYTES "${BYTES}")
+    string(APPEND DEFINITIONS "    // ${NAME}\n    constexpr unsigned char resource${INDEX}[] = {\n        ${BYTES}0x00\n    };\n")
+    string(APPEND ENTRIES "        {\"${NAME}\", resource${INDEX}, sizeof(resource${INDEX}) - 1},\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+set(SOURCE "// Generated by tools/embedResources.cmake, do not edit\n#include \"${HEADER}\"\n\nnamespace {\n${DEFINITIONS}}\n\n")
+string(APPEND SOURCE "namespace resources::detail {\n    const Entry ENTRIES[] = {\n${ENTRIES}        {nullptr, nullptr, 0} // keeps the array valid without resources\n    };\n")
+string(APPEND SOURCE "    const size_t ENTRY_COUNT = ${INDEX};\n}\n")
+
+# Only touch the file when it changes, so an unchanged resource set doesn't rebuild anything
+file(WRITE "${OUTPUT}.tmp" "${SOURCE}")
+execute_process(COMMAND ${CMAKE_COMMAND} -E copy_if_different "${OUTPUT}.tmp" "${OUTPUT}")
+file(REMOVE "${OUTPUT}.tmp")
@@ -0,0 +1,42 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+#include "../src/font/fontAtlas.h"
+
+// Bakes a font into the atlas file Font loads at startup, so launches skip FreeType.
+// Run by the bakeFonts target: fontBaker <font.ttf> <size> <bitmap|sdf> <output.atlas>
+int main(int argc, char *argv[]) {
+    if (argc != 5) {
+        std::cout << "Usage: fontBaker <font.ttf> <size> <bitmap|sdf> <output.atlas>" << std::endl;
+        return 1;
+    }
+
+    std::string fontPath = argv[1];
+    unsigned int fontSize = std::stoul(argv[2]);
+    std::string modeName = argv[3];
+    std::string outputPath = argv[4];
+    if (modeName != "bitmap" && modeName != "sdf") {
+        std::cout << "ERROR::FONTBAKER: Unknown glyph mode " << modeName << " (expected bitmap or sdf)" << std::endl;
+        return 1;
+    }
+    GlyphMode mode = modeName == "sdf" ? GlyphMode::SDF : GlyphMode::Bitmap;
+
+    std::ifstream fontFile(fontPath, std::ios::binary);
+    if (!fontFile) {
+        std::cout << "ERROR::FONTBAKER: Could not read " << fontPath << std::endl;
+        return 1;
+    }
+    std::string fontData((std::istreambuf_iterator<char>(fontFile)), std::istreambuf_iterator<char>());
+
+    FontAtlas atlas;
+    if (!atlas.rasterize(fontData, fontSize, mode))
+        return 1;
+    if (!atlas.save(outputPath, FontAtlas::hashSource(fontData, fontSize, mode)))
+        return 1;
+
+    std::cout << "Baked " << fontPath << " (" << atlas.getCharacters().size() << " glyphs, "
+              << atlas.getSize().x << "x" << atlas.getSize().y << ") into " << outputPath << std::endl;
+    return 0;
+}